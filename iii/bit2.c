@@ -7,7 +7,10 @@
  *      Implementation for two-dimensional bit arrays
  */
  
+#include <limits.h>
+#include <string.h>
 #include "bit2.h"
+#include "mapfile.h"
 
 #define T Bit2_T
 
@@ -15,9 +18,123 @@ struct T
 {
         int width;
         int height;
-        Bit_T array;
+        size_t words_per_row;
+        Arena_T arena;
+        void *map;
+        size_t map_bytes;
+        uint64_t *words;
 };
 
+/*
+ * Identifies a Bit2 grid file and its payload layout. Version 2 pads each
+ * row to whole words, matching the in-memory layout.
+ */
+#define MAP_MAGIC "BIT2"
+#define MAP_VERSION 2
+
+/*
+ * Bytes reserved for the header in front of the words, rounded up so the
+ * words are 16-byte aligned.
+ */
+#define HEADER_BYTES ((sizeof(struct T) + 15) & ~(size_t) 15)
+
+/*
+ * Each row starts on a word boundary and takes words_per_row words; bit col
+ * of a row is bit col % 64 (counting from the least significant) of the
+ * row's word col / 64. Padding bits past the width are always 0. A bit's
+ * index is its position counting across whole padded rows.
+ */
+static inline size_t bit_index(T bitmap, int col, int row)
+{
+        return (size_t) row * bitmap->words_per_row * 64 + col;
+}
+
+static inline int get_bit(T bitmap, size_t i)
+{
+        return (bitmap->words[i / 64] >> (i % 64)) & 1;
+}
+
+/* Mask of the bits of a row's last word that lie inside the width */
+static inline uint64_t last_word_mask(T bitmap)
+{
+        int tail = bitmap->width % 64;
+
+        return tail == 0 ? ~(uint64_t) 0 : ((uint64_t) 1 << tail) - 1;
+}
+
+/* Number of 1 bits in a word; compiles to one POPCNT where available */
+static inline int popcount(uint64_t word)
+{
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) +
+               ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return (int) ((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* Index of the lowest 1 bit of a non-zero word */
+static inline int lowest_bit(uint64_t word)
+{
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int i = 0;
+
+        while ((word & 1) == 0) {
+                word >>= 1;
+                i++;
+        }
+        return i;
+#endif
+}
+
+/* Index of the highest 1 bit of a non-zero word */
+static inline int highest_bit(uint64_t word)
+{
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(word);
+#else
+        int i = 63;
+
+        while ((word >> i) == 0) {
+                i--;
+        }
+        return i;
+#endif
+}
+
+static size_t count_words(const uint64_t *words, size_t n);
+static int run_end(T bitmap, const uint64_t *words, int col, int bit);
+static void map_bits(T bitmap, int bit,
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl);
+static size_t words_per_row(int width);
+static size_t word_count(int width, int height);
+static T new_in_block(char *block, int width, int height, Arena_T arena);
+static T new_mapped(char *map, size_t bytes, int width, int height);
+static uint64_t combine_word(uint64_t a, uint64_t b, Bit2_op op);
+static void combine_words(uint64_t *dst, const uint64_t *src, size_t n,
+                          Bit2_op op);
+static T combined(T s, T t, Bit2_op op);
+static void or_shifted_down(uint64_t *words, size_t n, int s);
+static void or_shifted_up(T bitmap, uint64_t *words, int s);
+static void dilate_rows(T bitmap, int before, int after);
+static void dilate_cols(T bitmap, int before, int after);
+static void dilate(T bitmap, T scratch, Bit2_element element, bool reflect);
+static void erode(T bitmap, T scratch, Bit2_element element, bool reflect);
+static void fill_runs_up(uint64_t *seeds, const uint64_t *mask, size_t n);
+static void reverse_row(uint64_t *dst, const uint64_t *src, size_t n);
+static bool grow_row(T marker, T mask, int row, int from, uint64_t *scratch);
+static uint64_t get_bits(T bitmap, size_t i, int n);
+static void put_bits(T bitmap, size_t i, int n, uint64_t bits);
+static uint64_t reverse_bits(uint64_t word);
+static void transpose_tile(uint64_t tile[64]);
+static T transpose(T src, bool mirror_cols, bool mirror_rows);
+static T flip(T src, bool mirror_cols, bool mirror_rows);
+
 /******** Bit2_new ********
  *
  * Creates a new 2D bit array with specified dimensions
@@ -32,20 +149,225 @@ struct T
  *      Throws CRE if invalid dimensions
  * Notes:
  *      Initializes all bits to 0 (white)
+ *      The header and the bits share one allocation
  ************************/
 T Bit2_new(int width, int height)
 {
         /* Ensure dimensions are valid */
         assert(width >= 0 && height >= 0);
 
-        /* Make a UArray object */
+        /* Header and words in one block */
+        char *block = calloc(1, HEADER_BYTES + word_count(width, height) *
+                             sizeof(uint64_t));
+        assert(block != NULL);
+
+        return new_in_block(block, width, height, NULL);
+}
+
+/******** Bit2_new_in ********
+ *
+ * Creates a new 2D bit array like Bit2_new, but takes its single block of
+ * memory from a client-supplied Hanson arena instead of malloc
+ *
+ * Parameters:
+ *      int width:      number of columns
+ *      int height:     number of rows
+ *      Arena_T arena:  the arena that owns the bitmap's memory
+ * Return: 
+ *      Pointer to new Bit2_T instance
+ * Expects:
+ *      width and height are non-negative
+ *      arena is not NULL
+ *      Throws CRE if invalid arguments
+ * Notes:
+ *      Initializes all bits to 0 (white)
+ *      Arena_calloc raises Arena_Failed if it runs out of memory
+ ************************/
+T Bit2_new_in(int width, int height, Arena_T arena)
+{
+        assert(width >= 0 && height >= 0 && arena != NULL);
+
+        size_t bytes = HEADER_BYTES + word_count(width, height) *
+                       sizeof(uint64_t);
+        assert(bytes <= LONG_MAX);
+
+        char *block = Arena_calloc(arena, 1, (long) bytes, __FILE__,
+                                   __LINE__);
+
+        return new_in_block(block, width, height, arena);
+}
+
+/******** Bit2_new_mapped ********
+ *
+ * Creates a new 2D bit array whose bits live in a memory-mapped file rather
+ * than on the heap. The file is created (or truncated) and laid out as
+ * described in mapfile.h; the payload is the bits in the same padded-row
+ * layout as in memory: each row packed into whole 64-bit words, least
+ * significant bit first.
+ *
+ * Parameters:
+ *      const char *path:       file to hold the bits
+ *      int width:              number of columns
+ *      int height:             number of rows
+ * Return: 
+ *      Pointer to new Bit2_T instance
+ * Expects:
+ *      path is not NULL
+ *      width and height are non-negative
+ *      Throws CRE if invalid arguments or the file cannot be created and
+ *      mapped
+ * Notes:
+ *      Initializes all bits to 0 (white)
+ ************************/
+T Bit2_new_mapped(const char *path, int width, int height)
+{
+        assert(path != NULL && width >= 0 && height >= 0);
+
+        Mapfile_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+        header.version = MAP_VERSION;
+        header.width = width;
+        header.height = height;
+
+        size_t payload = word_count(width, height) * sizeof(uint64_t);
+        char *map = Mapfile_create(path, header, payload);
+
+        return new_mapped(map, MAPFILE_HEADER_BYTES + payload, width, height);
+}
+
+/******** Bit2_open_mapped ********
+ *
+ * Maps an existing grid file made by Bit2_new_mapped. If writable, changes
+ * to the bits are written back to the file.
+ *
+ * Parameters:
+ *      const char *path:       grid file to open
+ *      bool writable:          whether changes should reach the file
+ * Return: 
+ *      Pointer to a Bit2_T over the file's bits
+ * Expects:
+ *      path is not NULL
+ *      Throws CRE if the file cannot be mapped or is not a Bit2 grid file of
+ *      a consistent length
+ * Notes:
+ *      Nothing is read up front; pages are faulted in as bits are touched.
+ *      A file opened with writable false only needs read permission; the
+ *      bitmap can still be changed, but only in this process's copy.
+ ************************/
+T Bit2_open_mapped(const char *path, bool writable)
+{
+        Mapfile_header header;
+        size_t bytes;
+        char *map = Mapfile_open(path, MAP_MAGIC, MAP_VERSION, writable,
+                                 &header, &bytes);
+
+        assert(header.width <= INT_MAX && header.height <= INT_MAX);
+        assert(bytes == MAPFILE_HEADER_BYTES +
+                        word_count(header.width, header.height) *
+                        sizeof(uint64_t));
+
+        return new_mapped(map, bytes, header.width, header.height);
+}
+
+/******** new_mapped ********
+ *
+ * Make a heap header for bits that live in a mapped grid file
+ *
+ * Parameters:
+ *      char *map:      start of the mapping
+ *      size_t bytes:   length of the mapping
+ *      int width:      number of columns
+ *      int height:     number of rows
+ * Return: 
+ *      the new bitmap
+ * Expects:
+ *      map is not NULL
+ *      Throws CRE if malloc fails
+ ************************/
+static T new_mapped(char *map, size_t bytes, int width, int height)
+{
         T bit2d = malloc(sizeof(*bit2d));
         assert(bit2d != NULL);
 
-        /* populate struct */
         bit2d->width = width;
         bit2d->height = height;
-        bit2d->array = Bit_new(width * height);
+        bit2d->words_per_row = words_per_row(width);
+        bit2d->arena = NULL;
+        bit2d->map = map;
+        bit2d->map_bytes = bytes;
+        bit2d->words = (uint64_t *) (map + MAPFILE_HEADER_BYTES);
+
+        return bit2d;
+}
+
+/******** words_per_row ********
+ *
+ * Number of 64-bit words in one padded row
+ *
+ * Parameters:
+ *      int width:      number of columns
+ * Return: 
+ *      width / 64, rounded up
+ * Expects:
+ *      width is non-negative
+ ************************/
+static size_t words_per_row(int width)
+{
+        return (size_t) width / 64 + (width % 64 != 0);
+}
+
+/******** word_count ********
+ *
+ * Number of 64-bit words needed to hold a width x height bitmap with padded
+ * rows
+ *
+ * Parameters:
+ *      int width:      number of columns
+ *      int height:     number of rows
+ * Return: 
+ *      the word count
+ * Expects:
+ *      width and height are non-negative
+ *      Throws CRE if the bitmap (plus room for a header) cannot be sized in
+ *      a size_t
+ ************************/
+static size_t word_count(int width, int height)
+{
+        size_t row_words = words_per_row(width);
+        size_t words = row_words * (size_t) height;
+        assert(height == 0 || words / (size_t) height == row_words);
+        assert(words <= (SIZE_MAX - HEADER_BYTES - MAPFILE_HEADER_BYTES) /
+                        sizeof(uint64_t));
+
+        return words;
+}
+
+/******** new_in_block ********
+ *
+ * Lay out a bitmap in a zeroed block: header first, words right after it
+ *
+ * Parameters:
+ *      char *block:    zeroed memory with room for the header and words
+ *      int width:      number of columns
+ *      int height:     number of rows
+ *      Arena_T arena:  arena that owns block, or NULL if it came from malloc
+ * Return: 
+ *      the new bitmap, which lives at the start of block
+ * Expects:
+ *      block is not NULL
+ ************************/
+static T new_in_block(char *block, int width, int height, Arena_T arena)
+{
+        T bit2d = (T) block;
+
+        bit2d->width = width;
+        bit2d->height = height;
+        bit2d->words_per_row = words_per_row(width);
+        bit2d->arena = arena;
+        bit2d->map = NULL;
+        bit2d->map_bytes = 0;
+        bit2d->words = (uint64_t *) (block + HEADER_BYTES);
 
         return bit2d;
 }
@@ -57,21 +379,29 @@ T Bit2_new(int width, int height)
  * Parameters:
  *      T *bitmap: pointer to Bit2_T instance to free
  * Return: 
- *      Nothing
+ *      Nothing, *bitmap is set to NULL
  * Expects:
  *      bitmap and *bitmap are not NULL
  *      Throws CRE if client passes NULL pointer
+ * Notes:
+ *      A bitmap made by Bit2_new_in is owned by its arena, so its memory is
+ *      only recycled when the client calls Arena_free or Arena_dispose.
+ *      A mapped bitmap is unmapped; its bits stay in the file.
  ************************/
 void Bit2_free(T *bitmap)
 {
         /* Ensure no pointers are NULL */
         assert(bitmap != NULL && *bitmap != NULL);
         
-        /* Free 1D bidmap */
-        Bit_free(&(*bitmap)->array);
+        if ((*bitmap)->map != NULL) {
+                Mapfile_close((*bitmap)->map, (*bitmap)->map_bytes);
+                free(*bitmap);
+        } else if ((*bitmap)->arena == NULL) {
+                /* Header and words are one block */
+                free(*bitmap);
+        }
 
-        /* Free actual struct */
-        free(*bitmap);
+        *bitmap = NULL;
 }
 
 /******** Bit2_width ********
@@ -133,7 +463,7 @@ int Bit2_get(T bitmap, int col, int row)
         assert(bitmap != NULL && 0 <= col && col < bitmap->width && 0 <= row &&
                 row < bitmap->height);
 
-        return Bit_get(bitmap->array, row * bitmap->width + col);
+        return get_bit(bitmap, bit_index(bitmap, col, row));
 }
 
 /******** Bit2_put ********
@@ -159,64 +489,1847 @@ int Bit2_put(T bitmap, int col, int row, int bit)
         assert(bitmap != NULL && 0 <= col && col < bitmap->width && 0 <= row &&
                 row < bitmap->height && 0 <= bit && bit <= 1);
 
-        return Bit_put(bitmap->array, row * bitmap->width + col, bit);
+        size_t i = bit_index(bitmap, col, row);
+        uint64_t mask = (uint64_t) 1 << (i % 64);
+        int prev = (bitmap->words[i / 64] & mask) != 0;
+
+        if (bit) {
+                bitmap->words[i / 64] |= mask;
+        } else {
+                bitmap->words[i / 64] &= ~mask;
+        }
+
+        return prev;
 }
 
+/******** Bit2_words_per_row ********
+ *
+ * Returns the number of 64-bit words in one padded row
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ * Return: 
+ *      width / 64, rounded up
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+int Bit2_words_per_row(T bitmap)
+{
+        assert(bitmap != NULL);
+
+        return (int) bitmap->words_per_row;
+}
 
-/******** Bit2_map_col_major ********
+/******** Bit2_get_word ********
  *
- * Applies function to each bit in column-major order
- * (processes each column completely before moving to next column)
+ * Retrieves 64 bits of a row at once: columns 64 * word through
+ * 64 * word + 63
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int word: word index within the row (0-based)
+ *      int row:  row index (0-based)
+ * Return: 
+ *      the word, column 64 * word in the least significant bit
+ * Expects:
+ *      bitmap is not NULL
+ *      word in range [0, words_per_row-1]
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Bits past the width in a row's last word are always 0.
+ ************************/
+uint64_t Bit2_get_word(T bitmap, int word, int row)
+{
+        assert(bitmap != NULL && 0 <= word &&
+               (size_t) word < bitmap->words_per_row && 0 <= row &&
+               row < bitmap->height);
+
+        return bitmap->words[row * bitmap->words_per_row + word];
+}
+
+/******** Bit2_put_word ********
+ *
+ * Sets 64 bits of a row at once: columns 64 * word through 64 * word + 63
  *
  * Parameters:
  *      T bitmap:       Bit2_T instance
- *      void apply:     general function pointer which takes, column, row, 
- *                      bitmap, bit, and closure as parameters
- *      void *cl:       closure pointer for client's implementation.
+ *      int word:       word index within the row (0-based)
+ *      int row:        row index (0-based)
+ *      uint64_t bits:  new values, column 64 * word in the least significant
+ *                      bit
  * Return: 
- *      Nothing
+ *      Previous word at that position
  * Expects:
- *      all arguments are not NULL
- *      Throws CRE if NULL pointers
+ *      bitmap is not NULL
+ *      word in range [0, words_per_row-1]
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Bits of the last word that lie past the width are ignored.
  ************************/
-void Bit2_map_col_major(T bitmap, 
-        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+uint64_t Bit2_put_word(T bitmap, int word, int row, uint64_t bits)
 {
-        assert(bitmap != NULL && apply != NULL && cl != NULL);
+        assert(bitmap != NULL && 0 <= word &&
+               (size_t) word < bitmap->words_per_row && 0 <= row &&
+               row < bitmap->height);
 
-        for (int col = 0; col < bitmap->width; col++) {
-                for (int row = 0; row < bitmap->height; row++) {
-                        apply(col, row, bitmap, Bit2_get(bitmap, col, row), cl);
-                }
+        uint64_t *at = bitmap->words + row * bitmap->words_per_row + word;
+        uint64_t prev = *at;
+
+        if ((size_t) word == bitmap->words_per_row - 1) {
+                bits &= last_word_mask(bitmap);
         }
+        *at = bits;
+
+        return prev;
 }
 
-/******** Bit2_map_row_major ********
+/******** Bit2_get_row ********
  *
- * Applies function to each bit in row-major order
- * (processes each column completely before moving to next column)
+ * Copies one whole row out of the bitmap
  *
  * Parameters:
  *      T bitmap:       Bit2_T instance
- *      void apply:     general function pointer which takes, column, row, 
- *                      bitmap, bit, and closure as parameters
- *      void *cl:       closure pointer for client's implementation.
+ *      int row:        row index (0-based)
+ *      uint64_t *words: room for words_per_row words
+ * Return: 
+ *      Nothing; words holds the row, column col in bit col % 64 of
+ *      words[col / 64]
+ * Expects:
+ *      bitmap and words are not NULL
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointers
+ ************************/
+void Bit2_get_row(T bitmap, int row, uint64_t *words)
+{
+        assert(bitmap != NULL && words != NULL && 0 <= row &&
+               row < bitmap->height);
+
+        memcpy(words, bitmap->words + row * bitmap->words_per_row,
+               bitmap->words_per_row * sizeof(uint64_t));
+}
+
+/******** Bit2_put_row ********
+ *
+ * Overwrites one whole row of the bitmap
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int row:        row index (0-based)
+ *      const uint64_t *words: words_per_row words laid out as Bit2_get_row
+ *                      fills them in
  * Return: 
  *      Nothing
  * Expects:
- *      all arguments are not NULL
- *      Throws CRE if NULL pointers
+ *      bitmap and words are not NULL
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointers
+ * Notes:
+ *      Bits of the last word that lie past the width are ignored.
  ************************/
-void Bit2_map_row_major(T bitmap, 
-        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+void Bit2_put_row(T bitmap, int row, const uint64_t *words)
 {
-        assert(bitmap != NULL && apply != NULL && cl != NULL);
+        assert(bitmap != NULL && words != NULL && 0 <= row &&
+               row < bitmap->height);
 
-        for (int row = 0; row < bitmap->height; row++) {
-                for (int col = 0; col < bitmap->width; col++) {
-                        apply(col, row, bitmap, Bit2_get(bitmap, col, row), cl);
+        size_t n = bitmap->words_per_row;
+        uint64_t *dst = bitmap->words + row * n;
+
+        if (n > 0) {
+                memcpy(dst, words, n * sizeof(uint64_t));
+                dst[n - 1] &= last_word_mask(bitmap);
+        }
+}
+
+/******** Bit2_next ********
+ *
+ * Finds the first column at or after col in a row whose bit is bit
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int col:  column to start from, 0 to width
+ *      int row:  row index (0-based)
+ *      int bit:  value to look for (0 or 1)
+ * Return: 
+ *      the column found, or width if there is none
+ * Expects:
+ *      bitmap is not NULL
+ *      col in range [0, width], row in range [0, height-1]
+ *      bit is either 0 or 1
+ *      Throws CRE if invalid parameters
+ * Notes:
+ *      Scans a word at a time with count-trailing-zeros
+ ************************/
+int Bit2_next(T bitmap, int col, int row, int bit)
+{
+        assert(bitmap != NULL && 0 <= col && col <= bitmap->width &&
+               0 <= row && row < bitmap->height && 0 <= bit && bit <= 1);
+
+        if (col == bitmap->width) {
+                return col;
+        }
+
+        return run_end(bitmap, bitmap->words + row * bitmap->words_per_row,
+                       col, !bit);
+}
+
+/******** Bit2_prev ********
+ *
+ * Finds the last column at or before col in a row whose bit is bit
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int col:  column to start from, -1 to width-1
+ *      int row:  row index (0-based)
+ *      int bit:  value to look for (0 or 1)
+ * Return: 
+ *      the column found, or -1 if there is none
+ * Expects:
+ *      bitmap is not NULL
+ *      col in range [-1, width-1], row in range [0, height-1]
+ *      bit is either 0 or 1
+ *      Throws CRE if invalid parameters
+ * Notes:
+ *      Scans a word at a time with count-leading-zeros
+ ************************/
+int Bit2_prev(T bitmap, int col, int row, int bit)
+{
+        assert(bitmap != NULL && -1 <= col && col < bitmap->width &&
+               0 <= row && row < bitmap->height && 0 <= bit && bit <= 1);
+
+        const uint64_t *words = bitmap->words + row * bitmap->words_per_row;
+        uint64_t flip = bit ? 0 : ~(uint64_t) 0;
+
+        for (int i = col < 0 ? -1 : col / 64; i >= 0; i--) {
+                uint64_t word = words[i] ^ flip;
+
+                if (i == col / 64 && col % 64 != 63) {
+                        word &= ((uint64_t) 1 << (col % 64 + 1)) - 1;
+                }
+                if (word != 0) {
+                        return i * 64 + highest_bit(word);
                 }
         }
+
+        return -1;
+}
+
+/******** Bit2_count ********
+ *
+ * Counts the 1 (black) bits in the whole bitmap
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ * Return: 
+ *      number of bits set
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Padding bits are always 0, so every word is counted whole.
+ ************************/
+size_t Bit2_count(T bitmap)
+{
+        assert(bitmap != NULL);
+
+        return count_words(bitmap->words,
+                           bitmap->words_per_row * bitmap->height);
+}
+
+/******** Bit2_count_row ********
+ *
+ * Counts the 1 (black) bits in one row
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int row:  row index (0-based)
+ * Return: 
+ *      number of bits set in the row
+ * Expects:
+ *      bitmap is not NULL
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ ************************/
+int Bit2_count_row(T bitmap, int row)
+{
+        assert(bitmap != NULL && 0 <= row && row < bitmap->height);
+
+        return (int) count_words(bitmap->words + row * bitmap->words_per_row,
+                                 bitmap->words_per_row);
+}
+
+/******** Bit2_count_rect ********
+ *
+ * Counts the 1 (black) bits in a rectangle of the bitmap
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      int col, int row:       top-left corner of the rectangle
+ *      int width, int height:  size of the rectangle
+ * Return: 
+ *      number of bits set inside the rectangle
+ * Expects:
+ *      bitmap is not NULL
+ *      width and height are non-negative and the rectangle lies inside the
+ *      bitmap
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Whole words inside the rectangle are counted directly; only the two
+ *      partial words at its left and right edges are masked.
+ ************************/
+size_t Bit2_count_rect(T bitmap, int col, int row, int width, int height)
+{
+        assert(bitmap != NULL && 0 <= col && 0 <= row && 0 <= width &&
+               0 <= height && width <= bitmap->width - col &&
+               height <= bitmap->height - row);
+
+        size_t total = 0;
+
+        if (width == 0) {
+                return 0;
+        }
+
+        int first = col / 64;
+        int last = (col + width - 1) / 64;
+        uint64_t head = ~(uint64_t) 0 << (col % 64);
+        uint64_t tail = ~(uint64_t) 0 >> (63 - (col + width - 1) % 64);
+
+        for (int r = row; r < row + height; r++) {
+                const uint64_t *words = bitmap->words +
+                                        r * bitmap->words_per_row;
+
+                if (first == last) {
+                        total += popcount(words[first] & head & tail);
+                        continue;
+                }
+                total += popcount(words[first] & head);
+                total += count_words(words + first + 1, last - first - 1);
+                total += popcount(words[last] & tail);
+        }
+
+        return total;
+}
+
+/******** Bit2_combine ********
+ *
+ * Combines src into dst bit by bit, in place: dst = dst op src
+ *
+ * Parameters:
+ *      T dst:          bitmap to update
+ *      T src:          bitmap to combine into dst
+ *      Bit2_op op:     BIT2_AND, BIT2_OR, BIT2_XOR or BIT2_MINUS
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      dst and src are not NULL and have the same width and height
+ *      op is one of the Bit2_op values
+ *      Throws CRE otherwise
+ * Notes:
+ *      Runs over whole words; padding stays 0 because it is 0 in both.
+ ************************/
+void Bit2_combine(T dst, T src, Bit2_op op)
+{
+        assert(dst != NULL && src != NULL && dst->width == src->width &&
+               dst->height == src->height);
+
+        combine_words(dst->words, src->words,
+                      dst->words_per_row * dst->height, op);
+}
+
+/******** Bit2_combine_rect ********
+ *
+ * Combines a rectangle of src into a same-sized rectangle of dst, in place
+ *
+ * Parameters:
+ *      T dst:                  bitmap to update
+ *      int dst_col, dst_row:   top-left corner of the rectangle in dst
+ *      T src:                  bitmap to combine into dst
+ *      int src_col, src_row:   top-left corner of the rectangle in src
+ *      int width, int height:  size of the rectangle
+ *      Bit2_op op:             BIT2_AND, BIT2_OR, BIT2_XOR or BIT2_MINUS
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      dst and src are not NULL
+ *      width and height are non-negative and both rectangles lie inside
+ *      their bitmaps
+ *      op is one of the Bit2_op values
+ *      Throws CRE otherwise
+ * Notes:
+ *      The rectangles may start at different bit offsets; each row is
+ *      handled up to 64 bits at a time. If dst and src are the same bitmap
+ *      the rectangles must either coincide or not overlap.
+ ************************/
+void Bit2_combine_rect(T dst, int dst_col, int dst_row, T src, int src_col,
+                       int src_row, int width, int height, Bit2_op op)
+{
+        assert(dst != NULL && src != NULL && 0 <= width && 0 <= height);
+        assert(0 <= dst_col && width <= dst->width - dst_col &&
+               0 <= dst_row && height <= dst->height - dst_row);
+        assert(0 <= src_col && width <= src->width - src_col &&
+               0 <= src_row && height <= src->height - src_row);
+
+        for (int r = 0; r < height; r++) {
+                size_t to = bit_index(dst, dst_col, dst_row + r);
+                size_t from = bit_index(src, src_col, src_row + r);
+
+                for (int col = 0; col < width; col += 64) {
+                        int n = width - col < 64 ? width - col : 64;
+                        uint64_t bits = get_bits(src, from + col, n);
+                        uint64_t old = get_bits(dst, to + col, n);
+
+                        put_bits(dst, to + col, n,
+                                 combine_word(old, bits, op));
+                }
+        }
+}
+
+/******** Bit2_union ********
+ *
+ * Makes a new bitmap that is s OR t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_union(T s, T t)
+{
+        return combined(s, t, BIT2_OR);
+}
+
+/******** Bit2_inter ********
+ *
+ * Makes a new bitmap that is s AND t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_inter(T s, T t)
+{
+        return combined(s, t, BIT2_AND);
+}
+
+/******** Bit2_minus ********
+ *
+ * Makes a new bitmap that is s AND NOT t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_minus(T s, T t)
+{
+        return combined(s, t, BIT2_MINUS);
+}
+
+/******** Bit2_diff ********
+ *
+ * Makes a new bitmap that is s XOR t: the pixels where s and t differ
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_diff(T s, T t)
+{
+        return combined(s, t, BIT2_XOR);
+}
+
+/******** Bit2_invert ********
+ *
+ * Flips every bit of the bitmap, in place
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+void Bit2_invert(T bitmap)
+{
+        assert(bitmap != NULL);
+
+        size_t n = bitmap->words_per_row;
+        uint64_t tail = last_word_mask(bitmap);
+
+        if (n == 0) {
+                return;
+        }
+
+        for (int row = 0; row < bitmap->height; row++) {
+                uint64_t *words = bitmap->words + row * n;
+
+                for (size_t i = 0; i < n; i++) {
+                        words[i] = ~words[i];
+                }
+                words[n - 1] &= tail;
+        }
+}
+
+/******** Bit2_invert_rect ********
+ *
+ * Flips every bit inside a rectangle of the bitmap, in place
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      int col, int row:       top-left corner of the rectangle
+ *      int width, int height:  size of the rectangle
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      width and height are non-negative and the rectangle lies inside the
+ *      bitmap
+ *      Throws CRE otherwise
+ ************************/
+void Bit2_invert_rect(T bitmap, int col, int row, int width, int height)
+{
+        assert(bitmap != NULL && 0 <= col && 0 <= row && 0 <= width &&
+               0 <= height && width <= bitmap->width - col &&
+               height <= bitmap->height - row);
+
+        for (int r = row; r < row + height; r++) {
+                size_t base = bit_index(bitmap, col, r);
+
+                for (int c = 0; c < width; c += 64) {
+                        int n = width - c < 64 ? width - c : 64;
+
+                        put_bits(bitmap, base + c, n,
+                                 ~get_bits(bitmap, base + c, n));
+                }
+        }
+}
+
+/******** Bit2_fill_rect ********
+ *
+ * Sets every bit inside a rectangle of the bitmap to the same value
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      int col, int row:       top-left corner of the rectangle
+ *      int width, int height:  size of the rectangle
+ *      int bit:                value to set (0 or 1)
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      width and height are non-negative and the rectangle lies inside the
+ *      bitmap
+ *      bit is either 0 or 1
+ *      Throws CRE otherwise
+ * Notes:
+ *      Each row is written up to 64 bits at a time
+ ************************/
+void Bit2_fill_rect(T bitmap, int col, int row, int width, int height,
+                    int bit)
+{
+        assert(bitmap != NULL && 0 <= col && 0 <= row && 0 <= width &&
+               0 <= height && width <= bitmap->width - col &&
+               height <= bitmap->height - row && 0 <= bit && bit <= 1);
+
+        uint64_t bits = bit ? ~(uint64_t) 0 : 0;
+
+        for (int r = row; r < row + height; r++) {
+                size_t base = bit_index(bitmap, col, r);
+
+                for (int c = 0; c < width; c += 64) {
+                        int n = width - c < 64 ? width - c : 64;
+
+                        put_bits(bitmap, base + c, n, bits);
+                }
+        }
+}
+
+/******** Bit2_morph ********
+ *
+ * Makes a new bitmap holding a morphological dilation, erosion, opening or
+ * closing of the given one
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      Bit2_morph_op op:       BIT2_DILATE, BIT2_ERODE, BIT2_OPEN or
+ *                              BIT2_CLOSE
+ *      Bit2_element element:   the structuring element
+ * Return: 
+ *      a new heap-allocated bitmap of the same size
+ * Expects:
+ *      bitmap is not NULL
+ *      element's width and height are positive
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      See Bit2_morph_in_place
+ ************************/
+T Bit2_morph(T bitmap, Bit2_morph_op op, Bit2_element element)
+{
+        assert(bitmap != NULL);
+
+        T result = Bit2_new(bitmap->width, bitmap->height);
+        T scratch = NULL;
+
+        memcpy(result->words, bitmap->words, bitmap->words_per_row *
+               bitmap->height * sizeof(uint64_t));
+        if (element.cross) {
+                scratch = Bit2_new(bitmap->width, bitmap->height);
+        }
+
+        Bit2_morph_in_place(result, scratch, op, element);
+
+        if (scratch != NULL) {
+                Bit2_free(&scratch);
+        }
+
+        return result;
+}
+
+/******** Bit2_morph_in_place ********
+ *
+ * Replaces a bitmap with its morphological dilation, erosion, opening or
+ * closing, using a second bitmap as the other half of a double buffer so
+ * nothing is allocated
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance, overwritten with the result
+ *      T scratch:              bitmap of the same size whose contents are
+ *                              overwritten, or NULL if element is not a
+ *                              cross
+ *      Bit2_morph_op op:       BIT2_DILATE, BIT2_ERODE, BIT2_OPEN or
+ *                              BIT2_CLOSE
+ *      Bit2_element element:   the structuring element
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      scratch is not NULL, is not bitmap, and has the same width and
+ *      height as bitmap whenever element is a cross
+ *      element's width and height are positive
+ *      Throws CRE otherwise
+ * Notes:
+ *      With the element's anchor on a pixel, dilation makes the pixel 1 if
+ *      any pixel under the element is 1, and erosion makes it 0 if any is
+ *      0. Pixels outside the bitmap count as 0 for dilation and 1 for
+ *      erosion, so nothing erodes in from the border. Opening is erosion
+ *      then dilation; closing is dilation then erosion. Their second step
+ *      uses the element reflected through its anchor, which only differs
+ *      for an even width or height, so opening never adds a pixel and
+ *      closing never removes one.
+ *      Rectangles are done separably, rows then columns, each as a few
+ *      shifted whole-word ORs (logarithmic in the element's size); erosion
+ *      is dilation of the inverse.
+ ************************/
+void Bit2_morph_in_place(T bitmap, T scratch, Bit2_morph_op op,
+                         Bit2_element element)
+{
+        assert(bitmap != NULL && 0 < element.width && 0 < element.height);
+        assert(!element.cross || (scratch != NULL && scratch != bitmap &&
+                                  scratch->width == bitmap->width &&
+                                  scratch->height == bitmap->height));
+
+        switch (op) {
+        case BIT2_DILATE:
+                dilate(bitmap, scratch, element, false);
+                return;
+        case BIT2_ERODE:
+                erode(bitmap, scratch, element, false);
+                return;
+        case BIT2_OPEN:
+                erode(bitmap, scratch, element, false);
+                dilate(bitmap, scratch, element, true);
+                return;
+        case BIT2_CLOSE:
+                dilate(bitmap, scratch, element, false);
+                erode(bitmap, scratch, element, true);
+                return;
+        }
+        assert(0);
+}
+
+/******** Bit2_reconstruct ********
+ *
+ * Grows marker inside mask: afterwards a bit of marker is 1 exactly when it
+ * is 1 in mask and joined, through 4-connected 1s of mask, to a bit that
+ * was 1 in marker (morphological reconstruction by dilation)
+ *
+ * Parameters:
+ *      T marker:       seeds, overwritten with the grown region
+ *      T mask:         bitmap the region may grow through
+ * Return: 
+ *      the number of sweeps made, each one top-down and one bottom-up
+ * Expects:
+ *      marker and mask are not NULL, are different, and have the same
+ *      width and height
+ *      Throws CRE otherwise, or if malloc fails
+ * Notes:
+ *      Seeds outside mask are dropped. Each row takes the rows above (on
+ *      the way down) or below (on the way up) ANDed with mask, then is
+ *      spread along its own runs of mask with carry-propagating adds, so a
+ *      horizontal run of any length fills in one pass. Sweeps repeat until
+ *      one changes nothing; the work is straight word passes with no
+ *      worklist.
+ ************************/
+int Bit2_reconstruct(T marker, T mask)
+{
+        assert(marker != NULL && mask != NULL && marker != mask &&
+               marker->width == mask->width &&
+               marker->height == mask->height);
+
+        size_t n = marker->words_per_row;
+        int sweeps = 0;
+        bool changed = true;
+
+        combine_words(marker->words, mask->words, n * marker->height,
+                      BIT2_AND);
+        if (n == 0 || marker->height == 0) {
+                return 0;
+        }
+
+        /* Room for a saved row and the reversed row and mask */
+        uint64_t *scratch = malloc(3 * n * sizeof(uint64_t));
+        assert(scratch != NULL);
+
+        while (changed) {
+                changed = false;
+                for (int row = 0; row < marker->height; row++) {
+                        changed |= grow_row(marker, mask, row, row - 1,
+                                            scratch);
+                }
+                for (int row = marker->height - 1; row >= 0; row--) {
+                        changed |= grow_row(marker, mask, row, row + 1,
+                                            scratch);
+                }
+                sweeps++;
+        }
+
+        free(scratch);
+
+        return sweeps;
+}
+
+
+/******** Bit2_map_col_major ********
+ *
+ * Applies function to each bit in column-major order
+ * (processes each column completely before moving to next column)
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     general function pointer which takes, column, row, 
+ *                      bitmap, bit, and closure as parameters
+ *      void *cl:       closure pointer for client's implementation.
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      all arguments are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+void Bit2_map_col_major(T bitmap, 
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL && cl != NULL);
+
+        for (int col = 0; col < bitmap->width; col++) {
+                for (int row = 0; row < bitmap->height; row++) {
+                        apply(col, row, bitmap, Bit2_get(bitmap, col, row), cl);
+                }
+        }
+}
+
+/******** Bit2_map_row_major ********
+ *
+ * Applies function to each bit in row-major order
+ * (processes each column completely before moving to next column)
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     general function pointer which takes, column, row, 
+ *                      bitmap, bit, and closure as parameters
+ *      void *cl:       closure pointer for client's implementation.
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      all arguments are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+void Bit2_map_row_major(T bitmap, 
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL && cl != NULL);
+
+        for (int row = 0; row < bitmap->height; row++) {
+                for (int col = 0; col < bitmap->width; col++) {
+                        apply(col, row, bitmap, Bit2_get(bitmap, col, row), cl);
+                }
+        }
+}
+
+/******** Bit2_map_col_major_until ********
+ *
+ * Applies function to each bit in column-major order until the function
+ * returns true
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      bool apply:     function applied to each bit; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation.
+ * Return: 
+ *      true if apply stopped the traversal early, false otherwise
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+bool Bit2_map_col_major_until(T bitmap, 
+        bool apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL);
+
+        for (int col = 0; col < bitmap->width; col++) {
+                for (int row = 0; row < bitmap->height; row++) {
+                        int bit = get_bit(bitmap,
+                                          bit_index(bitmap, col, row));
+                        if (apply(col, row, bitmap, bit, cl)) {
+                                return true;
+                        }
+                }
+        }
+
+        return false;
+}
+
+/******** Bit2_map_row_major_until ********
+ *
+ * Applies function to each bit in row-major order until the function
+ * returns true
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      bool apply:     function applied to each bit; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation.
+ * Return: 
+ *      true if apply stopped the traversal early, false otherwise
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+bool Bit2_map_row_major_until(T bitmap, 
+        bool apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL);
+
+        for (int row = 0; row < bitmap->height; row++) {
+                size_t base = bit_index(bitmap, 0, row);
+
+                for (int col = 0; col < bitmap->width; col++) {
+                        int bit = get_bit(bitmap, base + col);
+                        if (apply(col, row, bitmap, bit, cl)) {
+                                return true;
+                        }
+                }
+        }
+
+        return false;
+}
+
+/******** Bit2_map_row_spans ********
+ *
+ * Visit the bitmap one row at a time, handing apply the row's bits packed
+ * into 64-bit words
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each row, given the row index,
+ *                      the packed words, the bit offset of column 0 within
+ *                      words[0], the number of bits in the row, the bitmap,
+ *                      and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Rows are word-aligned, so offset is always 0. The words point
+ *      straight into the bitmap; nothing is copied.
+ ************************/
+void Bit2_map_row_spans(T bitmap,
+        void apply(int row, const uint64_t *words, int offset, int count,
+                   T bitmap, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL);
+
+        for (int row = 0; row < bitmap->height; row++) {
+                apply(row, bitmap->words + row * bitmap->words_per_row, 0,
+                      bitmap->width, bitmap, cl);
+        }
+}
+
+/******** Bit2_map_set ********
+ *
+ * Applies function to each 1 (black) bit in row-major order, skipping the
+ * 0 bits entirely
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each set bit, given its column,
+ *                      row, the bitmap, the bit (always 1), and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      All-zero words are skipped with one test each, so the cost follows
+ *      the number of set bits rather than the area. apply may change the
+ *      bitmap, but changes to the 64 bits around the one being visited are
+ *      not seen.
+ ************************/
+void Bit2_map_set(T bitmap,
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL);
+
+        map_bits(bitmap, 1, apply, cl);
+}
+
+/******** Bit2_map_clear ********
+ *
+ * Applies function to each 0 (white) bit in row-major order, skipping the
+ * 1 bits entirely
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each clear bit, given its column,
+ *                      row, the bitmap, the bit (always 0), and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Same as Bit2_map_set with the roles of 0 and 1 swapped
+ ************************/
+void Bit2_map_clear(T bitmap,
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL);
+
+        map_bits(bitmap, 0, apply, cl);
+}
+
+/******** Bit2_map_runs ********
+ *
+ * Visit the bitmap as horizontal runs of equal bits, row by row from left
+ * to right. Every pixel belongs to exactly one run.
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each run, given its row, first
+ *                      column, length, bit value, the bitmap, and the
+ *                      closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Runs are maximal, so adjacent runs in a row alternate in value. The
+ *      end of each run is found a word at a time with count-trailing-zeros,
+ *      so a long run costs one test per 64 pixels. apply must not change
+ *      the row being visited.
+ ************************/
+void Bit2_map_runs(T bitmap,
+        void apply(int row, int start, int length, int bit, T bitmap,
+                   void *cl), void *cl)
+{
+        assert(bitmap != NULL && apply != NULL);
+
+        for (int row = 0; row < bitmap->height; row++) {
+                const uint64_t *words = bitmap->words +
+                                        row * bitmap->words_per_row;
+                int col = 0;
+
+                while (col < bitmap->width) {
+                        int bit = (words[col / 64] >> (col % 64)) & 1;
+                        int end = run_end(bitmap, words, col, bit);
+
+                        apply(row, col, end - col, bit, bitmap, cl);
+                        col = end;
+                }
+        }
+}
+
+/******** Bit2_transpose ********
+ *
+ * Make a new bitmap holding the transpose of bitmap
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ * Return:
+ *      a new height x width bitmap, owned by the client
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      See transpose
+ ************************/
+T Bit2_transpose(T bitmap)
+{
+        return transpose(bitmap, false, false);
+}
+
+/******** Bit2_rotate ********
+ *
+ * Make a new bitmap holding bitmap rotated clockwise
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int degrees:    0, 90, 180, or 270
+ * Return:
+ *      a new bitmap, owned by the client
+ * Expects:
+ *      bitmap is not NULL and degrees is one of the values above
+ *      Throws CRE otherwise
+ * Notes:
+ *      90 is a transpose with mirrored columns, 270 a transpose with
+ *      mirrored rows, and 180 mirrors both without transposing.
+ ************************/
+T Bit2_rotate(T bitmap, int degrees)
+{
+        assert(degrees == 0 || degrees == 90 || degrees == 180 ||
+               degrees == 270);
+
+        switch (degrees) {
+        case 90:
+                return transpose(bitmap, true, false);
+        case 180:
+                return flip(bitmap, true, true);
+        case 270:
+                return transpose(bitmap, false, true);
+        default:
+                return flip(bitmap, false, false);
+        }
+}
+
+/******** Bit2_flip_horizontal ********
+ *
+ * Make a new bitmap holding bitmap mirrored left to right
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ * Return:
+ *      a new bitmap of the same dimensions, owned by the client
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+T Bit2_flip_horizontal(T bitmap)
+{
+        return flip(bitmap, true, false);
+}
+
+/******** Bit2_flip_vertical ********
+ *
+ * Make a new bitmap holding bitmap mirrored top to bottom
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ * Return:
+ *      a new bitmap of the same dimensions, owned by the client
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+T Bit2_flip_vertical(T bitmap)
+{
+        return flip(bitmap, false, true);
+}
+
+/******** count_words ********
+ *
+ * Count the 1 bits in a run of words
+ *
+ * Parameters:
+ *      const uint64_t *words:  the words
+ *      size_t n:               how many words to count
+ * Return:
+ *      the total number of bits set
+ * Expects:
+ *      words points at n readable words (or n is 0)
+ * Notes:
+ *      Four independent partial sums keep several popcounts in flight at
+ *      once instead of serializing on one accumulator.
+ ************************/
+static size_t count_words(const uint64_t *words, size_t n)
+{
+        size_t sums[4] = { 0, 0, 0, 0 };
+        size_t i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+                sums[0] += popcount(words[i]);
+                sums[1] += popcount(words[i + 1]);
+                sums[2] += popcount(words[i + 2]);
+                sums[3] += popcount(words[i + 3]);
+        }
+        for (; i < n; i++) {
+                sums[0] += popcount(words[i]);
+        }
+
+        return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+/******** combine_word ********
+ *
+ * Apply a bitwise operation to one pair of words
+ *
+ * Parameters:
+ *      uint64_t a, uint64_t b: the operands
+ *      Bit2_op op:             the operation
+ * Return:
+ *      a op b
+ * Expects:
+ *      op is one of the Bit2_op values. Throws CRE otherwise.
+ ************************/
+static uint64_t combine_word(uint64_t a, uint64_t b, Bit2_op op)
+{
+        switch (op) {
+        case BIT2_AND:
+                return a & b;
+        case BIT2_OR:
+                return a | b;
+        case BIT2_XOR:
+                return a ^ b;
+        case BIT2_MINUS:
+                return a & ~b;
+        }
+        assert(0);
+        return 0;
+}
+
+/******** combine_words ********
+ *
+ * Apply a bitwise operation across two runs of words: dst = dst op src
+ *
+ * Parameters:
+ *      uint64_t *dst:          words to update
+ *      const uint64_t *src:    words to combine in
+ *      size_t n:               number of words
+ *      Bit2_op op:             the operation
+ * Return:
+ *      nothing
+ * Expects:
+ *      op is one of the Bit2_op values. Throws CRE otherwise.
+ * Notes:
+ *      The switch sits outside the loops so each loop is a plain
+ *      elementwise operation the compiler can vectorize.
+ ************************/
+static void combine_words(uint64_t *dst, const uint64_t *src, size_t n,
+                          Bit2_op op)
+{
+        switch (op) {
+        case BIT2_AND:
+                for (size_t i = 0; i < n; i++) {
+                        dst[i] &= src[i];
+                }
+                return;
+        case BIT2_OR:
+                for (size_t i = 0; i < n; i++) {
+                        dst[i] |= src[i];
+                }
+                return;
+        case BIT2_XOR:
+                for (size_t i = 0; i < n; i++) {
+                        dst[i] ^= src[i];
+                }
+                return;
+        case BIT2_MINUS:
+                for (size_t i = 0; i < n; i++) {
+                        dst[i] &= ~src[i];
+                }
+                return;
+        }
+        assert(0);
+}
+
+/******** combined ********
+ *
+ * Make a new bitmap holding s op t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ *      Bit2_op op:     the operation
+ * Return:
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+static T combined(T s, T t, Bit2_op op)
+{
+        assert(s != NULL && t != NULL && s->width == t->width &&
+               s->height == t->height);
+
+        T result = Bit2_new(s->width, s->height);
+
+        memcpy(result->words, s->words,
+               s->words_per_row * s->height * sizeof(uint64_t));
+        combine_words(result->words, t->words,
+                      result->words_per_row * result->height, op);
+
+        return result;
+}
+
+/******** run_end ********
+ *
+ * Find where the run of bits starting at col ends
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      const uint64_t *words:  the row's words
+ *      int col:                first column of the run
+ *      int bit:                value of the run
+ * Return:
+ *      the first column after col whose bit differs, or the width
+ * Expects:
+ *      col is inside the row
+ * Notes:
+ *      Each word is flipped so the run's value reads as 0; the first 1 at or
+ *      after col is then the end. Padding is masked off the last word.
+ ************************/
+static int run_end(T bitmap, const uint64_t *words, int col, int bit)
+{
+        size_t n = bitmap->words_per_row;
+        uint64_t flip = bit ? ~(uint64_t) 0 : 0;
+
+        for (size_t i = col / 64; i < n; i++) {
+                uint64_t word = words[i] ^ flip;
+
+                if (i == (size_t) col / 64) {
+                        word &= ~(uint64_t) 0 << (col % 64);
+                }
+                if (i == n - 1) {
+                        word &= last_word_mask(bitmap);
+                }
+                if (word != 0) {
+                        return (int) (i * 64) + lowest_bit(word);
+                }
+        }
+
+        return bitmap->width;
+}
+
+/******** map_bits ********
+ *
+ * Call apply on every bit of the bitmap equal to bit, row-major
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int bit:        which bits to visit, 0 or 1
+ *      void apply:     function applied to each matching bit
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ * Notes:
+ *      When visiting 0 bits each word is inverted first, masking off the
+ *      padding so it is never reported. Each matching bit is found with a
+ *      count-trailing-zeros and then cleared from the local copy.
+ ************************/
+static void map_bits(T bitmap, int bit,
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl)
+{
+        size_t n = bitmap->words_per_row;
+        uint64_t flip = bit ? 0 : ~(uint64_t) 0;
+        uint64_t tail = last_word_mask(bitmap);
+
+        for (int row = 0; row < bitmap->height; row++) {
+                const uint64_t *words = bitmap->words + row * n;
+
+                for (size_t i = 0; i < n; i++) {
+                        uint64_t word = words[i] ^ flip;
+
+                        if (i == n - 1) {
+                                word &= tail;
+                        }
+                        while (word != 0) {
+                                int col = (int) (i * 64) + lowest_bit(word);
+
+                                apply(col, row, bitmap, bit, cl);
+                                word &= word - 1;
+                        }
+                }
+        }
+}
+
+/******** or_shifted_down ********
+ *
+ * OR a row with itself moved s columns toward column 0, so that afterwards
+ * column c also holds what was in column c + s
+ *
+ * Parameters:
+ *      uint64_t *words:        the row
+ *      size_t n:               words in the row
+ *      int s:                  distance to move, non-negative
+ * Return:
+ *      nothing
+ * Notes:
+ *      Words are updated in increasing order; each reads only itself and
+ *      higher words, which still hold their old values. Columns past the
+ *      row read as 0.
+ ************************/
+static void or_shifted_down(uint64_t *words, size_t n, int s)
+{
+        size_t q = (size_t) s / 64;
+        int r = s % 64;
+
+        for (size_t i = 0; i + q < n; i++) {
+                uint64_t low = words[i + q];
+                uint64_t high = i + q + 1 < n ? words[i + q + 1] : 0;
+
+                words[i] |= r == 0 ? low : (low >> r) | (high << (64 - r));
+        }
+}
+
+/******** or_shifted_up ********
+ *
+ * OR a row with itself moved s columns away from column 0, so that
+ * afterwards column c also holds what was in column c - s
+ *
+ * Parameters:
+ *      T bitmap:               the bitmap the row belongs to
+ *      uint64_t *words:        the row
+ *      int s:                  distance to move, non-negative
+ * Return:
+ *      nothing
+ * Notes:
+ *      Words are updated in decreasing order so each reads only itself and
+ *      lower words that still hold their old values. Bits pushed into the
+ *      padding are cleared.
+ ************************/
+static void or_shifted_up(T bitmap, uint64_t *words, int s)
+{
+        size_t n = bitmap->words_per_row;
+        size_t q = (size_t) s / 64;
+        int r = s % 64;
+
+        if (n == 0) {
+                return;
+        }
+
+        for (size_t i = n; i-- > q;) {
+                uint64_t high = words[i - q];
+                uint64_t low = i > q ? words[i - q - 1] : 0;
+
+                words[i] |= r == 0 ? high : (high << r) | (low >> (64 - r));
+        }
+        words[n - 1] &= last_word_mask(bitmap);
+}
+
+/******** dilate_rows ********
+ *
+ * Dilate every row of a bitmap by a horizontal line running from before
+ * columns left of the anchor to after columns right of it
+ *
+ * Parameters:
+ *      T bitmap:       bitmap to update in place
+ *      int before:     pixels of the line left of the anchor, non-negative
+ *      int after:      pixels of the line right of the anchor, non-negative
+ * Return:
+ *      nothing
+ * Notes:
+ *      The line is the sum of [0, after] and [-before, 0], done one after
+ *      the other. Each is built by doubling: after ORing in shifts
+ *      totalling len - 1, column c covers len columns, so a line of k
+ *      pixels takes about log2(k) whole-row passes.
+ ************************/
+static void dilate_rows(T bitmap, int before, int after)
+{
+        size_t n = bitmap->words_per_row;
+
+        for (int row = 0; row < bitmap->height; row++) {
+                uint64_t *words = bitmap->words + row * n;
+
+                for (int len = 1; len <= after;) {
+                        int step = len * 2 <= after + 1 ? len :
+                                   after + 1 - len;
+                        or_shifted_down(words, n, step);
+                        len += step;
+                }
+                for (int len = 1; len <= before;) {
+                        int step = len * 2 <= before + 1 ? len :
+                                   before + 1 - len;
+                        or_shifted_up(bitmap, words, step);
+                        len += step;
+                }
+        }
+}
+
+/******** dilate_cols ********
+ *
+ * Dilate every column of a bitmap by a vertical line running from before
+ * rows above the anchor to after rows below it
+ *
+ * Parameters:
+ *      T bitmap:       bitmap to update in place
+ *      int before:     pixels of the line above the anchor, non-negative
+ *      int after:      pixels of the line below the anchor, non-negative
+ * Return:
+ *      nothing
+ * Notes:
+ *      Same doubling as dilate_rows, but ORing whole rows together, so
+ *      every step is a straight pass over contiguous words. Rows are
+ *      updated away from the row being read, which still holds its old
+ *      value.
+ ************************/
+static void dilate_cols(T bitmap, int before, int after)
+{
+        size_t total = bitmap->words_per_row * bitmap->height;
+        uint64_t *words = bitmap->words;
+
+        for (int len = 1; len <= after;) {
+                int step = len * 2 <= after + 1 ? len : after + 1 - len;
+                size_t shift = step * bitmap->words_per_row;
+
+                for (size_t i = 0; i + shift < total; i++) {
+                        words[i] |= words[i + shift];
+                }
+                len += step;
+        }
+        for (int len = 1; len <= before;) {
+                int step = len * 2 <= before + 1 ? len : before + 1 - len;
+                size_t shift = step * bitmap->words_per_row;
+
+                for (size_t i = total; i-- > shift;) {
+                        words[i] |= words[i - shift];
+                }
+                len += step;
+        }
+}
+
+/******** dilate ********
+ *
+ * Dilate a bitmap in place by a structuring element
+ *
+ * Parameters:
+ *      T bitmap:               bitmap to update
+ *      T scratch:              second buffer, used only for a cross
+ *      Bit2_element element:   the structuring element
+ *      bool reflect:           whether to use the element reflected
+ *                              through its anchor instead
+ * Return:
+ *      nothing
+ * Notes:
+ *      A rectangle is its row line followed by its column line. A cross is
+ *      the union of the two lines, each applied to its own copy. With an
+ *      even width or height the anchor is off-centre, and reflecting moves
+ *      the extra pixel to the other side.
+ ************************/
+static void dilate(T bitmap, T scratch, Bit2_element element, bool reflect)
+{
+        int left = element.width / 2;
+        int right = element.width - 1 - left;
+        int up = element.height / 2;
+        int down = element.height - 1 - up;
+
+        if (reflect) {
+                int swap = left;
+                left = right;
+                right = swap;
+                swap = up;
+                up = down;
+                down = swap;
+        }
+
+        if (!element.cross) {
+                dilate_rows(bitmap, left, right);
+                dilate_cols(bitmap, up, down);
+                return;
+        }
+
+        size_t n = bitmap->words_per_row * bitmap->height;
+
+        memcpy(scratch->words, bitmap->words, n * sizeof(uint64_t));
+        dilate_rows(bitmap, left, right);
+        dilate_cols(scratch, up, down);
+        combine_words(bitmap->words, scratch->words, n, BIT2_OR);
+}
+
+/******** erode ********
+ *
+ * Erode a bitmap in place by a structuring element
+ *
+ * Parameters:
+ *      T bitmap:               bitmap to update
+ *      T scratch:              second buffer, used only for a cross
+ *      Bit2_element element:   the structuring element
+ *      bool reflect:           whether to use the element reflected
+ *                              through its anchor instead
+ * Return:
+ *      nothing
+ * Notes:
+ *      A pixel survives erosion when no pixel under the element is 0, which
+ *      is the inverse of dilating the inverse. Dilation treats the outside
+ *      as 0, which is why erosion treats it as 1.
+ ************************/
+static void erode(T bitmap, T scratch, Bit2_element element, bool reflect)
+{
+        Bit2_invert(bitmap);
+        dilate(bitmap, scratch, element, reflect);
+        Bit2_invert(bitmap);
+}
+
+/******** fill_runs_up ********
+ *
+ * Spread seeds toward higher columns along runs of 1s in a mask row
+ *
+ * Parameters:
+ *      uint64_t *seeds:        the row of seeds, updated in place
+ *      const uint64_t *mask:   the mask row; seeds are a subset of it
+ *      size_t n:               words in the row
+ * Return:
+ *      nothing
+ * Notes:
+ *      Treating a row as one n-word number, mask + seeds carries from each
+ *      seed up through the rest of its run, flipping those bits. ANDing
+ *      the flipped bits with mask and adding the seeds back gives every
+ *      bit of a run from its lowest seed upward.
+ ************************/
+static void fill_runs_up(uint64_t *seeds, const uint64_t *mask, size_t n)
+{
+        uint64_t carry = 0;
+
+        for (size_t i = 0; i < n; i++) {
+                uint64_t partial = mask[i] + seeds[i];
+                uint64_t sum = partial + carry;
+
+                carry = (partial < mask[i]) | (sum < partial);
+                seeds[i] |= (sum ^ mask[i]) & mask[i];
+        }
+}
+
+/******** reverse_row ********
+ *
+ * Reverse the bit order of a whole padded row
+ *
+ * Parameters:
+ *      uint64_t *dst:          where to put the reversed row
+ *      const uint64_t *src:    the row
+ *      size_t n:               words in the row
+ * Return:
+ *      nothing
+ * Expects:
+ *      dst and src do not overlap
+ ************************/
+static void reverse_row(uint64_t *dst, const uint64_t *src, size_t n)
+{
+        for (size_t i = 0; i < n; i++) {
+                dst[i] = reverse_bits(src[n - 1 - i]);
+        }
+}
+
+/******** grow_row ********
+ *
+ * One step of Bit2_reconstruct: pull the region in from a neighboring row,
+ * then fill every run of mask in this row that the region touches
+ *
+ * Parameters:
+ *      T marker:               the growing region
+ *      T mask:                 bitmap the region may grow through
+ *      int row:                the row to update
+ *      int from:               the neighboring row, possibly out of range
+ *      uint64_t *scratch:      room for 3 rows
+ * Return:
+ *      true if the row changed
+ * Notes:
+ *      Runs are filled upward, then downward by doing the same on the
+ *      reversed row.
+ ************************/
+static bool grow_row(T marker, T mask, int row, int from, uint64_t *scratch)
+{
+        size_t n = marker->words_per_row;
+        uint64_t *seeds = marker->words + row * n;
+        const uint64_t *bounds = mask->words + row * n;
+        uint64_t *saved = scratch;
+        uint64_t *rev_seeds = scratch + n;
+        uint64_t *rev_bounds = scratch + 2 * n;
+        bool changed = false;
+
+        memcpy(saved, seeds, n * sizeof(uint64_t));
+
+        if (0 <= from && from < marker->height) {
+                const uint64_t *near = marker->words + from * n;
+
+                for (size_t i = 0; i < n; i++) {
+                        seeds[i] |= near[i] & bounds[i];
+                }
+        }
+
+        fill_runs_up(seeds, bounds, n);
+        reverse_row(rev_seeds, seeds, n);
+        reverse_row(rev_bounds, bounds, n);
+        fill_runs_up(rev_seeds, rev_bounds, n);
+        reverse_row(seeds, rev_seeds, n);
+
+        for (size_t i = 0; i < n; i++) {
+                changed |= seeds[i] != saved[i];
+        }
+
+        return changed;
+}
+
+/******** get_bits ********
+ *
+ * Read n consecutive bits starting at flat bit index i
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      size_t i:       index of the first bit (see bit_index)
+ *      int n:          number of bits, 1 to 64
+ * Return: 
+ *      the bits, bit i in the least significant position, with everything
+ *      above the first n bits cleared
+ * Expects:
+ *      all n bits lie inside the bitmap
+ ************************/
+static uint64_t get_bits(T bitmap, size_t i, int n)
+{
+        size_t w = i / 64;
+        int off = i % 64;
+        uint64_t bits = bitmap->words[w] >> off;
+
+        if (off + n > 64) {
+                bits |= bitmap->words[w + 1] << (64 - off);
+        }
+        if (n < 64) {
+                bits &= ((uint64_t) 1 << n) - 1;
+        }
+
+        return bits;
+}
+
+/******** put_bits ********
+ *
+ * Overwrite n consecutive bits starting at flat bit index i
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      size_t i:       index of the first bit (see bit_index)
+ *      int n:          number of bits, 1 to 64
+ *      uint64_t bits:  new values, bit i in the least significant position
+ * Return: 
+ *      nothing
+ * Expects:
+ *      all n bits lie inside the bitmap
+ * Notes:
+ *      Bits of the argument above the first n are ignored
+ ************************/
+static void put_bits(T bitmap, size_t i, int n, uint64_t bits)
+{
+        size_t w = i / 64;
+        int off = i % 64;
+        uint64_t mask = n < 64 ? ((uint64_t) 1 << n) - 1 : ~(uint64_t) 0;
+
+        bits &= mask;
+        bitmap->words[w] = (bitmap->words[w] & ~(mask << off)) |
+                           (bits << off);
+
+        if (off + n > 64) {
+                int low = 64 - off;
+                bitmap->words[w + 1] = (bitmap->words[w + 1] &
+                                        ~(mask >> low)) | (bits >> low);
+        }
+}
+
+/******** reverse_bits ********
+ *
+ * Reverse the order of the 64 bits of a word
+ *
+ * Parameters:
+ *      uint64_t word:  word to reverse
+ * Return: 
+ *      word with bit k moved to bit 63 - k
+ ************************/
+static uint64_t reverse_bits(uint64_t word)
+{
+        word = ((word >> 1) & 0x5555555555555555ULL) |
+               ((word & 0x5555555555555555ULL) << 1);
+        word = ((word >> 2) & 0x3333333333333333ULL) |
+               ((word & 0x3333333333333333ULL) << 2);
+        word = ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL) |
+               ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        word = ((word >> 8) & 0x00FF00FF00FF00FFULL) |
+               ((word & 0x00FF00FF00FF00FFULL) << 8);
+        word = ((word >> 16) & 0x0000FFFF0000FFFFULL) |
+               ((word & 0x0000FFFF0000FFFFULL) << 16);
+
+        return (word >> 32) | (word << 32);
+}
+
+/******** transpose_tile ********
+ *
+ * Transpose a 64 x 64 bit matrix in place, where bit c of tile[r] is
+ * element (c, r)
+ *
+ * Parameters:
+ *      uint64_t tile[64]:      the matrix
+ * Return: 
+ *      nothing
+ * Notes:
+ *      Swaps the off-diagonal 32 x 32 blocks, then the 16 x 16 blocks inside
+ *      each quadrant, and so on down to single bits: six rounds of 32 word
+ *      operations each instead of 4096 single-bit moves.
+ ************************/
+static void transpose_tile(uint64_t tile[64])
+{
+        uint64_t mask = 0x00000000FFFFFFFFULL;
+
+        for (int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+                for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                        uint64_t t = ((tile[k] >> j) ^ tile[k | j]) & mask;
+                        tile[k] ^= t << j;
+                        tile[k | j] ^= t;
+                }
+        }
+}
+
+/******** transpose ********
+ *
+ * Make a transposed copy of src, optionally mirroring the columns and/or
+ * rows of the result
+ *
+ * Parameters:
+ *      T src:                  bitmap to transpose
+ *      bool mirror_cols:       true to mirror the result left to right
+ *      bool mirror_rows:       true to mirror the result top to bottom
+ * Return: 
+ *      the new height x width bitmap
+ * Expects:
+ *      src is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Source rows [top, top + 64) and columns [left, left + 64) are read as
+ *      64 words, transposed, and each resulting word is written as 64 bits
+ *      of one result row. Mirroring happens while writing: a mirrored
+ *      column run is bit-reversed and placed from the other end of the row.
+ ************************/
+static T transpose(T src, bool mirror_cols, bool mirror_rows)
+{
+        assert(src != NULL);
+
+        int width = src->width;
+        int height = src->height;
+        T dst = Bit2_new(height, width);
+        uint64_t tile[64];
+
+        for (int top = 0; top < height; top += 64) {
+                int rows = height - top < 64 ? height - top : 64;
+
+                for (int left = 0; left < width; left += 64) {
+                        int cols = width - left < 64 ? width - left : 64;
+
+                        for (int k = 0; k < 64; k++) {
+                                tile[k] = k < rows ?
+                                        get_bits(src, bit_index(src, left,
+                                                 top + k), cols) : 0;
+                        }
+
+                        transpose_tile(tile);
+
+                        /* tile[k] now holds source column left + k */
+                        for (int k = 0; k < cols; k++) {
+                                int dst_row = left + k;
+                                int dst_col = top;
+                                uint64_t bits = tile[k];
+
+                                if (mirror_rows) {
+                                        dst_row = width - 1 - dst_row;
+                                }
+                                if (mirror_cols) {
+                                        dst_col = height - top - rows;
+                                        bits = reverse_bits(bits) >>
+                                               (64 - rows);
+                                }
+
+                                put_bits(dst, bit_index(dst, dst_col,
+                                         dst_row), rows, bits);
+                        }
+                }
+        }
+
+        return dst;
+}
+
+/******** flip ********
+ *
+ * Make a copy of src, optionally mirroring its columns and/or rows
+ *
+ * Parameters:
+ *      T src:                  bitmap to copy
+ *      bool mirror_cols:       true to mirror left to right
+ *      bool mirror_rows:       true to mirror top to bottom
+ * Return: 
+ *      the new bitmap, same dimensions as src
+ * Expects:
+ *      src is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Each row is moved 64 bits at a time; mirrored runs are read from the
+ *      far end of the source row and bit-reversed.
+ ************************/
+static T flip(T src, bool mirror_cols, bool mirror_rows)
+{
+        assert(src != NULL);
+
+        int width = src->width;
+        int height = src->height;
+        T dst = Bit2_new(width, height);
+
+        for (int row = 0; row < height; row++) {
+                size_t from = bit_index(src, 0, row);
+                size_t to = bit_index(dst, 0, mirror_rows ? height - 1 - row :
+                                      row);
+
+                for (int col = 0; col < width; col += 64) {
+                        int n = width - col < 64 ? width - col : 64;
+                        uint64_t bits;
+
+                        if (mirror_cols) {
+                                bits = get_bits(src, from + width - col - n,
+                                                n);
+                                bits = reverse_bits(bits) >> (64 - n);
+                        } else {
+                                bits = get_bits(src, from + col, n);
+                        }
+
+                        put_bits(dst, to + col, n, bits);
+                }
+        }
+
+        return dst;
 }
 
-#undef T
\ No newline at end of file
+#undef T
@@ -4,13 +4,17 @@
  *      September 25, 2025
  *      iii
  * 
- *      Interface for two-dimensional bit arrays
+ *      Interface for two-dimensional bit arrays. Each row is packed into
+ *      whole 64-bit words, column col in bit col % 64 (counting from the
+ *      least significant) of the row's word col / 64, so a row can be read
+ *      or written 64 bits at a time. Padding bits past the width are 0.
  */
  
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include "bit.h"
+#include <stdint.h>
+#include "arena.h"
 #include "assert.h"
 
 #ifndef BIT2_INCLUDED
@@ -20,6 +24,37 @@
 
 typedef struct T *T;
 
+/* Bitwise operations for Bit2_combine and Bit2_combine_rect */
+typedef enum {
+        BIT2_AND,       /* dst & src */
+        BIT2_OR,        /* dst | src */
+        BIT2_XOR,       /* dst ^ src */
+        BIT2_MINUS      /* dst & ~src */
+} Bit2_op;
+
+/* Operations for Bit2_morph and Bit2_morph_in_place */
+typedef enum {
+        BIT2_DILATE,
+        BIT2_ERODE,
+        BIT2_OPEN,      /* erode, then dilate */
+        BIT2_CLOSE      /* dilate, then erode */
+} Bit2_morph_op;
+
+/*
+ * A structuring element: a width x height rectangle anchored at
+ * (width / 2, height / 2), or, if cross is set, just the rectangle's
+ * anchor row and anchor column
+ */
+typedef struct Bit2_element {
+        int width;
+        int height;
+        bool cross;
+} Bit2_element;
+
+/* The 4- and 8-connected 3x3 neighbourhoods */
+#define BIT2_CONNECT4 ((Bit2_element) { 3, 3, true })
+#define BIT2_CONNECT8 ((Bit2_element) { 3, 3, false })
+
 /******** Bit2_new ********
  *
  * Creates a new 2D bit array with specified dimensions
@@ -34,9 +69,78 @@ typedef struct T *T;
  *      Throws CRE if invalid dimensions
  * Notes:
  *      Initializes all bits to 0 (white)
+ *      The header and the bits share one allocation
+ *      width * height is computed in size_t, so a bitmap may hold more than
+ *      2^31 bits (e.g. 100k x 100k); throws a CRE if the total does not fit.
  ************************/
 T Bit2_new(int width, int height);
 
+/******** Bit2_new_in ********
+ *
+ * Creates a new 2D bit array like Bit2_new, but takes its single block of
+ * memory from a client-supplied Hanson arena instead of malloc
+ *
+ * Parameters:
+ *      int width:      number of columns
+ *      int height:     number of rows
+ *      Arena_T arena:  the arena that owns the bitmap's memory
+ * Return: 
+ *      Pointer to new Bit2_T instance
+ * Expects:
+ *      width and height are non-negative
+ *      arena is not NULL
+ *      Throws CRE if invalid arguments
+ * Notes:
+ *      Initializes all bits to 0 (white)
+ *      Arena_calloc raises Arena_Failed if it runs out of memory
+ ************************/
+T Bit2_new_in(int width, int height, Arena_T arena);
+
+/******** Bit2_new_mapped ********
+ *
+ * Creates a new 2D bit array whose bits live in a memory-mapped file rather
+ * than on the heap, for bitmaps too large to hold comfortably in memory. The
+ * file is created (or truncated) and laid out as described in mapfile.h; the
+ * payload is the bits in the same padded-row layout as in memory.
+ *
+ * Parameters:
+ *      const char *path:       file to hold the bits
+ *      int width:              number of columns
+ *      int height:             number of rows
+ * Return: 
+ *      Pointer to new Bit2_T instance
+ * Expects:
+ *      path is not NULL
+ *      width and height are non-negative
+ *      Throws CRE if invalid arguments or the file cannot be created and
+ *      mapped
+ * Notes:
+ *      Initializes all bits to 0 (white). The mapping is shared, so other
+ *      processes that map the same file see the same bits.
+ ************************/
+T Bit2_new_mapped(const char *path, int width, int height);
+
+/******** Bit2_open_mapped ********
+ *
+ * Maps an existing grid file made by Bit2_new_mapped. If writable, changes
+ * to the bits are written back to the file.
+ *
+ * Parameters:
+ *      const char *path:       grid file to open
+ *      bool writable:          whether changes should reach the file
+ * Return: 
+ *      Pointer to a Bit2_T over the file's bits
+ * Expects:
+ *      path is not NULL
+ *      Throws CRE if the file cannot be mapped or is not a Bit2 grid file of
+ *      a consistent length
+ * Notes:
+ *      Nothing is read up front; pages are faulted in as bits are touched.
+ *      A file opened with writable false only needs read permission; the
+ *      bitmap can still be changed, but only in this process's copy.
+ ************************/
+T Bit2_open_mapped(const char *path, bool writable);
+
 /******** Bit2_free ********
  *
  * Deallocates memory used by a 2D bit array
@@ -44,10 +148,14 @@ T Bit2_new(int width, int height);
  * Parameters:
  *      T *bitmap: pointer to Bit2_T instance to free
  * Return: 
- *      Nothing
+ *      Nothing, *bitmap is set to NULL
  * Expects:
  *      bitmap and *bitmap are not NULL
  *      Throws CRE if client passes NULL pointer
+ * Notes:
+ *      A bitmap made by Bit2_new_in is owned by its arena, so its memory is
+ *      only recycled when the client calls Arena_free or Arena_dispose.
+ *      A mapped bitmap is unmapped; its bits stay in the file.
  ************************/
 void Bit2_free(T *bitmap);
 
@@ -117,6 +225,437 @@ int Bit2_get(T bitmap, int col, int row);
  ************************/
 int Bit2_put(T bitmap, int col, int row, int bit);
 
+/******** Bit2_words_per_row ********
+ *
+ * Returns the number of 64-bit words in one padded row
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ * Return: 
+ *      width / 64, rounded up
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+int Bit2_words_per_row(T bitmap);
+
+/******** Bit2_get_word ********
+ *
+ * Retrieves 64 bits of a row at once: columns 64 * word through
+ * 64 * word + 63
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int word: word index within the row (0-based)
+ *      int row:  row index (0-based)
+ * Return: 
+ *      the word, column 64 * word in the least significant bit
+ * Expects:
+ *      bitmap is not NULL
+ *      word in range [0, words_per_row-1]
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Bits past the width in a row's last word are always 0.
+ ************************/
+uint64_t Bit2_get_word(T bitmap, int word, int row);
+
+/******** Bit2_put_word ********
+ *
+ * Sets 64 bits of a row at once: columns 64 * word through 64 * word + 63
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int word:       word index within the row (0-based)
+ *      int row:        row index (0-based)
+ *      uint64_t bits:  new values, column 64 * word in the least significant
+ *                      bit
+ * Return: 
+ *      Previous word at that position
+ * Expects:
+ *      bitmap is not NULL
+ *      word in range [0, words_per_row-1]
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Bits of the last word that lie past the width are ignored.
+ ************************/
+uint64_t Bit2_put_word(T bitmap, int word, int row, uint64_t bits);
+
+/******** Bit2_get_row ********
+ *
+ * Copies one whole row out of the bitmap
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int row:        row index (0-based)
+ *      uint64_t *words: room for words_per_row words
+ * Return: 
+ *      Nothing; words holds the row, column col in bit col % 64 of
+ *      words[col / 64]
+ * Expects:
+ *      bitmap and words are not NULL
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointers
+ ************************/
+void Bit2_get_row(T bitmap, int row, uint64_t *words);
+
+/******** Bit2_put_row ********
+ *
+ * Overwrites one whole row of the bitmap
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int row:        row index (0-based)
+ *      const uint64_t *words: words_per_row words laid out as Bit2_get_row
+ *                      fills them in
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and words are not NULL
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointers
+ * Notes:
+ *      Bits of the last word that lie past the width are ignored.
+ ************************/
+void Bit2_put_row(T bitmap, int row, const uint64_t *words);
+
+/******** Bit2_next ********
+ *
+ * Finds the first column at or after col in a row whose bit is bit
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int col:  column to start from, 0 to width
+ *      int row:  row index (0-based)
+ *      int bit:  value to look for (0 or 1)
+ * Return: 
+ *      the column found, or width if there is none
+ * Expects:
+ *      bitmap is not NULL
+ *      col in range [0, width], row in range [0, height-1]
+ *      bit is either 0 or 1
+ *      Throws CRE if invalid parameters
+ * Notes:
+ *      Scans a word at a time with count-trailing-zeros
+ ************************/
+int Bit2_next(T bitmap, int col, int row, int bit);
+
+/******** Bit2_prev ********
+ *
+ * Finds the last column at or before col in a row whose bit is bit
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int col:  column to start from, -1 to width-1
+ *      int row:  row index (0-based)
+ *      int bit:  value to look for (0 or 1)
+ * Return: 
+ *      the column found, or -1 if there is none
+ * Expects:
+ *      bitmap is not NULL
+ *      col in range [-1, width-1], row in range [0, height-1]
+ *      bit is either 0 or 1
+ *      Throws CRE if invalid parameters
+ * Notes:
+ *      Scans a word at a time with count-leading-zeros
+ ************************/
+int Bit2_prev(T bitmap, int col, int row, int bit);
+
+/******** Bit2_count ********
+ *
+ * Counts the 1 (black) bits in the whole bitmap
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ * Return: 
+ *      number of bits set
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Padding bits are always 0, so every word is counted whole.
+ ************************/
+size_t Bit2_count(T bitmap);
+
+/******** Bit2_count_row ********
+ *
+ * Counts the 1 (black) bits in one row
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ *      int row:  row index (0-based)
+ * Return: 
+ *      number of bits set in the row
+ * Expects:
+ *      bitmap is not NULL
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ ************************/
+int Bit2_count_row(T bitmap, int row);
+
+/******** Bit2_count_rect ********
+ *
+ * Counts the 1 (black) bits in a rectangle of the bitmap
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      int col, int row:       top-left corner of the rectangle
+ *      int width, int height:  size of the rectangle
+ * Return: 
+ *      number of bits set inside the rectangle
+ * Expects:
+ *      bitmap is not NULL
+ *      width and height are non-negative and the rectangle lies inside the
+ *      bitmap
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Whole words inside the rectangle are counted directly; only the two
+ *      partial words at its left and right edges are masked.
+ ************************/
+size_t Bit2_count_rect(T bitmap, int col, int row, int width, int height);
+
+/******** Bit2_combine ********
+ *
+ * Combines src into dst bit by bit, in place: dst = dst op src
+ *
+ * Parameters:
+ *      T dst:          bitmap to update
+ *      T src:          bitmap to combine into dst
+ *      Bit2_op op:     BIT2_AND, BIT2_OR, BIT2_XOR or BIT2_MINUS
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      dst and src are not NULL and have the same width and height
+ *      op is one of the Bit2_op values
+ *      Throws CRE otherwise
+ * Notes:
+ *      Runs over whole words; padding stays 0 because it is 0 in both.
+ ************************/
+void Bit2_combine(T dst, T src, Bit2_op op);
+
+/******** Bit2_combine_rect ********
+ *
+ * Combines a rectangle of src into a same-sized rectangle of dst, in place
+ *
+ * Parameters:
+ *      T dst:                  bitmap to update
+ *      int dst_col, dst_row:   top-left corner of the rectangle in dst
+ *      T src:                  bitmap to combine into dst
+ *      int src_col, src_row:   top-left corner of the rectangle in src
+ *      int width, int height:  size of the rectangle
+ *      Bit2_op op:             BIT2_AND, BIT2_OR, BIT2_XOR or BIT2_MINUS
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      dst and src are not NULL
+ *      width and height are non-negative and both rectangles lie inside
+ *      their bitmaps
+ *      op is one of the Bit2_op values
+ *      Throws CRE otherwise
+ * Notes:
+ *      The rectangles may start at different bit offsets; each row is
+ *      handled up to 64 bits at a time. If dst and src are the same bitmap
+ *      the rectangles must either coincide or not overlap.
+ ************************/
+void Bit2_combine_rect(T dst, int dst_col, int dst_row, T src, int src_col,
+                       int src_row, int width, int height, Bit2_op op);
+
+/******** Bit2_union ********
+ *
+ * Makes a new bitmap that is s OR t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_union(T s, T t);
+
+/******** Bit2_inter ********
+ *
+ * Makes a new bitmap that is s AND t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_inter(T s, T t);
+
+/******** Bit2_minus ********
+ *
+ * Makes a new bitmap that is s AND NOT t
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_minus(T s, T t);
+
+/******** Bit2_diff ********
+ *
+ * Makes a new bitmap that is s XOR t: the pixels where s and t differ
+ *
+ * Parameters:
+ *      T s, T t:       bitmaps of the same width and height
+ * Return: 
+ *      a new heap-allocated bitmap
+ * Expects:
+ *      s and t are not NULL and have the same width and height
+ *      Throws CRE otherwise, or if allocation fails
+ ************************/
+T Bit2_diff(T s, T t);
+
+/******** Bit2_invert ********
+ *
+ * Flips every bit of the bitmap, in place
+ *
+ * Parameters:
+ *      T bitmap: Bit2_T instance
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+void Bit2_invert(T bitmap);
+
+/******** Bit2_invert_rect ********
+ *
+ * Flips every bit inside a rectangle of the bitmap, in place
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      int col, int row:       top-left corner of the rectangle
+ *      int width, int height:  size of the rectangle
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      width and height are non-negative and the rectangle lies inside the
+ *      bitmap
+ *      Throws CRE otherwise
+ ************************/
+void Bit2_invert_rect(T bitmap, int col, int row, int width, int height);
+
+/******** Bit2_fill_rect ********
+ *
+ * Sets every bit inside a rectangle of the bitmap to the same value
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      int col, int row:       top-left corner of the rectangle
+ *      int width, int height:  size of the rectangle
+ *      int bit:                value to set (0 or 1)
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      width and height are non-negative and the rectangle lies inside the
+ *      bitmap
+ *      bit is either 0 or 1
+ *      Throws CRE otherwise
+ * Notes:
+ *      Each row is written up to 64 bits at a time
+ ************************/
+void Bit2_fill_rect(T bitmap, int col, int row, int width, int height,
+                    int bit);
+
+/******** Bit2_morph ********
+ *
+ * Makes a new bitmap holding a morphological dilation, erosion, opening or
+ * closing of the given one
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance
+ *      Bit2_morph_op op:       BIT2_DILATE, BIT2_ERODE, BIT2_OPEN or
+ *                              BIT2_CLOSE
+ *      Bit2_element element:   the structuring element
+ * Return: 
+ *      a new heap-allocated bitmap of the same size
+ * Expects:
+ *      bitmap is not NULL
+ *      element's width and height are positive
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      See Bit2_morph_in_place
+ ************************/
+T Bit2_morph(T bitmap, Bit2_morph_op op, Bit2_element element);
+
+/******** Bit2_morph_in_place ********
+ *
+ * Replaces a bitmap with its morphological dilation, erosion, opening or
+ * closing, using a second bitmap as the other half of a double buffer so
+ * nothing is allocated
+ *
+ * Parameters:
+ *      T bitmap:               Bit2_T instance, overwritten with the result
+ *      T scratch:              bitmap of the same size whose contents are
+ *                              overwritten, or NULL if element is not a
+ *                              cross
+ *      Bit2_morph_op op:       BIT2_DILATE, BIT2_ERODE, BIT2_OPEN or
+ *                              BIT2_CLOSE
+ *      Bit2_element element:   the structuring element
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      scratch is not NULL, is not bitmap, and has the same width and
+ *      height as bitmap whenever element is a cross
+ *      element's width and height are positive
+ *      Throws CRE otherwise
+ * Notes:
+ *      With the element's anchor on a pixel, dilation makes the pixel 1 if
+ *      any pixel under the element is 1, and erosion makes it 0 if any is
+ *      0. Pixels outside the bitmap count as 0 for dilation and 1 for
+ *      erosion, so nothing erodes in from the border. Opening is erosion
+ *      then dilation; closing is dilation then erosion. Their second step
+ *      uses the element reflected through its anchor, which only differs
+ *      for an even width or height, so opening never adds a pixel and
+ *      closing never removes one.
+ *      Rectangles are done separably, rows then columns, each as a few
+ *      shifted whole-word ORs (logarithmic in the element's size); erosion
+ *      is dilation of the inverse.
+ ************************/
+void Bit2_morph_in_place(T bitmap, T scratch, Bit2_morph_op op,
+                         Bit2_element element);
+
+/******** Bit2_reconstruct ********
+ *
+ * Grows marker inside mask: afterwards a bit of marker is 1 exactly when it
+ * is 1 in mask and joined, through 4-connected 1s of mask, to a bit that
+ * was 1 in marker (morphological reconstruction by dilation)
+ *
+ * Parameters:
+ *      T marker:       seeds, overwritten with the grown region
+ *      T mask:         bitmap the region may grow through
+ * Return: 
+ *      the number of sweeps made, each one top-down and one bottom-up
+ * Expects:
+ *      marker and mask are not NULL, are different, and have the same
+ *      width and height
+ *      Throws CRE otherwise, or if malloc fails
+ * Notes:
+ *      Seeds outside mask are dropped. Each row takes the rows above (on
+ *      the way down) or below (on the way up) ANDed with mask, then is
+ *      spread along its own runs of mask with carry-propagating adds, so a
+ *      horizontal run of any length fills in one pass. Sweeps repeat until
+ *      one changes nothing; the work is straight word passes with no
+ *      worklist.
+ ************************/
+int Bit2_reconstruct(T marker, T mask);
+
 /******** Bit2_map_col_major ********
  *
  * Applies function to each bit in column-major order
@@ -155,5 +694,211 @@ void Bit2_map_col_major(T bitmap,
 void Bit2_map_row_major(T bitmap, 
         void apply(int col, int row, T bitmap, int bit, void *cl), void *cl);
 
+/******** Bit2_map_col_major_until ********
+ *
+ * Applies function to each bit in column-major order until the function
+ * returns true, so a search can stop as soon as it has its answer
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      bool apply:     function applied to each bit; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation.
+ * Return: 
+ *      true if apply stopped the traversal early, false if every bit was
+ *      visited
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+bool Bit2_map_col_major_until(T bitmap, 
+        bool apply(int col, int row, T bitmap, int bit, void *cl), void *cl);
+
+/******** Bit2_map_row_major_until ********
+ *
+ * Applies function to each bit in row-major order until the function
+ * returns true
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      bool apply:     function applied to each bit; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation.
+ * Return: 
+ *      true if apply stopped the traversal early, false if every bit was
+ *      visited
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+bool Bit2_map_row_major_until(T bitmap, 
+        bool apply(int col, int row, T bitmap, int bit, void *cl), void *cl);
+
+/******** Bit2_map_row_spans ********
+ *
+ * Visit the bitmap one row at a time. apply is called once per row with the
+ * row's bits packed into 64-bit words, so the client can work on up to 64
+ * pixels per operation instead of paying for a function call per pixel.
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each row, given the row index,
+ *                      the packed words, the bit offset of column 0 within
+ *                      words[0], the number of bits in the row, the bitmap,
+ *                      and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Column col of the row is bit (offset + col) % 64 of
+ *      words[(offset + col) / 64], counting from the least significant bit.
+ *      Rows are word-aligned, so offset is currently always 0.
+ *      The words are read-only and only valid for the duration of the call.
+ ************************/
+void Bit2_map_row_spans(T bitmap,
+        void apply(int row, const uint64_t *words, int offset, int count,
+                   T bitmap, void *cl), void *cl);
+
+/******** Bit2_map_set ********
+ *
+ * Applies function to each 1 (black) bit in row-major order, skipping the
+ * 0 bits entirely
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each set bit, given its column,
+ *                      row, the bitmap, the bit (always 1), and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      All-zero words are skipped with one test each, so the cost follows
+ *      the number of set bits rather than the area. apply may change the
+ *      bitmap, but changes to the 64 bits around the one being visited are
+ *      not seen.
+ ************************/
+void Bit2_map_set(T bitmap,
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl);
+
+/******** Bit2_map_clear ********
+ *
+ * Applies function to each 0 (white) bit in row-major order, skipping the
+ * 1 bits entirely
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each clear bit, given its column,
+ *                      row, the bitmap, the bit (always 0), and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Same as Bit2_map_set with the roles of 0 and 1 swapped
+ ************************/
+void Bit2_map_clear(T bitmap,
+        void apply(int col, int row, T bitmap, int bit, void *cl), void *cl);
+
+/******** Bit2_map_runs ********
+ *
+ * Visit the bitmap as horizontal runs of equal bits, row by row from left
+ * to right. Every pixel belongs to exactly one run.
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      void apply:     function applied to each run, given its row, first
+ *                      column, length, bit value, the bitmap, and the
+ *                      closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return: 
+ *      Nothing
+ * Expects:
+ *      bitmap and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Runs are maximal, so adjacent runs in a row alternate in value. The
+ *      end of each run is found a word at a time with count-trailing-zeros,
+ *      so a long run costs one test per 64 pixels. apply must not change
+ *      the row being visited.
+ ************************/
+void Bit2_map_runs(T bitmap,
+        void apply(int row, int start, int length, int bit, T bitmap,
+                   void *cl), void *cl);
+
+/******** Bit2_transpose ********
+ *
+ * Make a new bitmap holding the transpose: bit (col, row) of the original is
+ * bit (row, col) of the result
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ * Return:
+ *      a new height x width bitmap, owned by the client
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Works on 64 x 64 tiles: 64 words are gathered, transposed as a bit
+ *      matrix with word operations, and written back 64 bits at a time.
+ ************************/
+T Bit2_transpose(T bitmap);
+
+/******** Bit2_rotate ********
+ *
+ * Make a new bitmap holding the original rotated clockwise
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ *      int degrees:    0, 90, 180, or 270
+ * Return:
+ *      a new bitmap, owned by the client (height x width for 90 and 270)
+ * Expects:
+ *      bitmap is not NULL and degrees is one of the values above
+ *      Throws CRE otherwise
+ * Notes:
+ *      90 and 270 use the same 64 x 64 tiles as Bit2_transpose
+ ************************/
+T Bit2_rotate(T bitmap, int degrees);
+
+/******** Bit2_flip_horizontal ********
+ *
+ * Make a new bitmap holding the original mirrored left to right
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ * Return:
+ *      a new bitmap of the same dimensions, owned by the client
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Rows are reversed 64 bits at a time
+ ************************/
+T Bit2_flip_horizontal(T bitmap);
+
+/******** Bit2_flip_vertical ********
+ *
+ * Make a new bitmap holding the original mirrored top to bottom
+ *
+ * Parameters:
+ *      T bitmap:       Bit2_T instance
+ * Return:
+ *      a new bitmap of the same dimensions, owned by the client
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Rows are copied 64 bits at a time
+ ************************/
+T Bit2_flip_vertical(T bitmap);
+
 #undef T
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,799 @@
+/*
+ *      bit2_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Test for the word-at-a-time parts of Bit2. Each check keeps the
+ *      same image as plain bytes, one per pixel, and compares what Bit2
+ *      does against that pixel by pixel. Widths sit on and around word
+ *      boundaries, and every bitmap is also checked for the invariant that
+ *      the padding bits past the width in each row's last word stay 0.
+ *
+ *      Usage: bit2_test
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "bit2.h"
+#include "assert.h"
+
+/* An image kept one byte per pixel, row-major */
+typedef struct Pixels {
+        int width;
+        int height;
+        unsigned char *at;
+} Pixels;
+
+/* What a sparse map has seen so far, for checking the next pixel it visits */
+typedef struct Visits {
+        Pixels pixels;
+        int bit;
+        size_t count;
+        int last_col;
+        int last_row;
+        bool ok;
+} Visits;
+
+bool check_words(int width, int height, uint64_t *state);
+bool check_rows(int width, int height, uint64_t *state);
+bool check_counts(int width, int height, uint64_t *state);
+size_t count_pixels(Pixels pixels, int col, int row, int width, int height);
+bool check_algebra(int width, int height, uint64_t *state);
+bool check_rects(int width, int height, uint64_t *state);
+int apply_op(Bit2_op op, int dst, int src);
+bool check_maps(int width, int height, uint64_t *state);
+void check_visit(int col, int row, Bit2_T bitmap, int bit, void *cl);
+Bit2_T make_image(Pixels pixels, uint64_t *state);
+Bit2_T to_bitmap(Pixels pixels);
+bool same(Bit2_T bitmap, Pixels pixels);
+bool padding_clear(Bit2_T bitmap);
+uint64_t pixel_word(Pixels pixels, int word, int row);
+void put_pixel_word(Pixels pixels, int word, int row, uint64_t bits);
+Pixels new_pixels(int width, int height);
+void free_pixels(Pixels *pixels);
+uint64_t next_random(uint64_t *state);
+
+/******** main ********
+ *
+ * Run every check on every size and report the failures
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every check passed, EXIT_FAILURE otherwise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      none
+ ************************/
+int main(void)
+{
+        static const int sizes[][2] = {
+                { 0, 3 },  { 1, 5 },  { 5, 0 },   { 63, 4 },  { 64, 4 },
+                { 65, 4 }, { 127, 3 }, { 128, 3 }, { 129, 3 }, { 200, 6 }
+        };
+        int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+        uint64_t state = 0x9e3779b97f4a7c15u;
+        int failures = 0;
+
+        for (int i = 0; i < nsizes; i++) {
+                int width = sizes[i][0];
+                int height = sizes[i][1];
+
+                if (!check_words(width, height, &state)) {
+                        printf("FAIL: %d x %d words\n", width, height);
+                        failures++;
+                }
+                if (!check_rows(width, height, &state)) {
+                        printf("FAIL: %d x %d rows\n", width, height);
+                        failures++;
+                }
+                if (!check_counts(width, height, &state)) {
+                        printf("FAIL: %d x %d counts\n", width, height);
+                        failures++;
+                }
+                if (!check_algebra(width, height, &state)) {
+                        printf("FAIL: %d x %d algebra\n", width, height);
+                        failures++;
+                }
+                if (!check_rects(width, height, &state)) {
+                        printf("FAIL: %d x %d rectangles\n", width, height);
+                        failures++;
+                }
+                if (!check_maps(width, height, &state)) {
+                        printf("FAIL: %d x %d sparse maps\n", width, height);
+                        failures++;
+                }
+        }
+
+        printf("bit2_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_words ********
+ *
+ * Check Bit2_put_word and Bit2_get_word against single pixels
+ *
+ * Parameters:
+ *      int width, height:      size of the bitmap
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if random words put in read back pixel by pixel, with their
+ *      bits past the width dropped, and each put returns the word it
+ *      replaced
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      Every word is written twice, so the second write's return value is
+ *      the first write after masking. Single pixels are then changed with
+ *      Bit2_put and read back a word at a time.
+ ************************/
+bool check_words(int width, int height, uint64_t *state)
+{
+        Bit2_T bitmap = Bit2_new(width, height);
+        Pixels pixels = new_pixels(width, height);
+        int words = Bit2_words_per_row(bitmap);
+        bool ok = words == (width + 63) / 64;
+
+        for (int pass = 0; pass < 2; pass++) {
+                for (int row = 0; row < height; row++) {
+                        for (int word = 0; word < words; word++) {
+                                uint64_t bits = next_random(state);
+                                uint64_t old = pixel_word(pixels, word, row);
+
+                                ok = ok && Bit2_put_word(bitmap, word, row,
+                                                         bits) == old;
+                                put_pixel_word(pixels, word, row, bits);
+                        }
+                }
+                ok = ok && same(bitmap, pixels);
+        }
+
+        for (int i = 0; i < width * height; i++) {
+                int col = (int) (next_random(state) % (uint64_t) width);
+                int row = (int) (next_random(state) % (uint64_t) height);
+                int bit = (int) (next_random(state) & 1);
+
+                Bit2_put(bitmap, col, row, bit);
+                pixels.at[row * width + col] = bit;
+                ok = ok && Bit2_get_word(bitmap, col / 64, row) ==
+                           pixel_word(pixels, col / 64, row);
+        }
+
+        ok = ok && same(bitmap, pixels);
+        Bit2_free(&bitmap);
+        free_pixels(&pixels);
+
+        return ok;
+}
+
+/******** check_rows ********
+ *
+ * Check Bit2_put_row and Bit2_get_row against single pixels
+ *
+ * Parameters:
+ *      int width, height:      size of the bitmap
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if random rows put in read back pixel by pixel, with their bits
+ *      past the width dropped, and Bit2_get_row hands back the same words
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      Rows are put in twice, the second time in reverse order, so each row
+ *      is overwritten rather than only written into a blank bitmap.
+ ************************/
+bool check_rows(int width, int height, uint64_t *state)
+{
+        Bit2_T bitmap = Bit2_new(width, height);
+        Pixels pixels = new_pixels(width, height);
+        int words = Bit2_words_per_row(bitmap);
+        uint64_t *row_words = malloc((words + 1) * sizeof(uint64_t));
+        bool ok = true;
+
+        assert(row_words != NULL);
+        for (int pass = 0; pass < 2; pass++) {
+                for (int i = 0; i < height; i++) {
+                        int row = pass == 0 ? i : height - 1 - i;
+
+                        for (int word = 0; word < words; word++) {
+                                row_words[word] = next_random(state);
+                                put_pixel_word(pixels, word, row,
+                                               row_words[word]);
+                        }
+                        Bit2_put_row(bitmap, row, row_words);
+                }
+                ok = ok && same(bitmap, pixels);
+        }
+
+        for (int row = 0; row < height; row++) {
+                Bit2_get_row(bitmap, row, row_words);
+                for (int word = 0; word < words; word++) {
+                        ok = ok && row_words[word] ==
+                                   pixel_word(pixels, word, row);
+                }
+        }
+
+        free(row_words);
+        Bit2_free(&bitmap);
+        free_pixels(&pixels);
+
+        return ok;
+}
+
+/******** check_counts ********
+ *
+ * Check Bit2_count, Bit2_count_row and Bit2_count_rect against a count of
+ * single pixels
+ *
+ * Parameters:
+ *      int width, height:      size of the bitmap
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if all three counts agree with the pixels, for the whole image,
+ *      each row, and random rectangles including empty ones
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      The image is all 1s first, then noise, so that full words are
+ *      counted as well as mixed ones.
+ ************************/
+bool check_counts(int width, int height, uint64_t *state)
+{
+        Pixels pixels = new_pixels(width, height);
+        bool ok = true;
+
+        for (int pass = 0; pass < 2; pass++) {
+                Bit2_T bitmap = make_image(pixels, state);
+
+                if (pass == 0) {
+                        Bit2_fill_rect(bitmap, 0, 0, width, height, 1);
+                        memset(pixels.at, 1, (size_t) width * height);
+                }
+
+                ok = ok && Bit2_count(bitmap) ==
+                           count_pixels(pixels, 0, 0, width, height) &&
+                     Bit2_count_rect(bitmap, 0, 0, width, height) ==
+                           Bit2_count(bitmap);
+                for (int row = 0; row < height; row++) {
+                        ok = ok && (size_t) Bit2_count_row(bitmap, row) ==
+                                   count_pixels(pixels, 0, row, width, 1);
+                }
+                for (int i = 0; i < 50 && width > 0 && height > 0; i++) {
+                        int col = (int) (next_random(state) %
+                                         (uint64_t) width);
+                        int row = (int) (next_random(state) %
+                                         (uint64_t) height);
+                        int w = (int) (next_random(state) %
+                                       (uint64_t) (width - col + 1));
+                        int h = (int) (next_random(state) %
+                                       (uint64_t) (height - row + 1));
+
+                        ok = ok && Bit2_count_rect(bitmap, col, row, w, h) ==
+                                   count_pixels(pixels, col, row, w, h);
+                }
+
+                Bit2_free(&bitmap);
+        }
+
+        free_pixels(&pixels);
+
+        return ok;
+}
+
+/******** count_pixels ********
+ *
+ * Count the 1 pixels in a rectangle, one at a time
+ *
+ * Parameters:
+ *      Pixels pixels:          the pixels
+ *      int col, row:           top-left corner of the rectangle
+ *      int width, height:      size of the rectangle
+ * Return:
+ *      the number of 1s inside it
+ * Expects:
+ *      the rectangle lies inside the image
+ * Notes:
+ *      none
+ ************************/
+size_t count_pixels(Pixels pixels, int col, int row, int width, int height)
+{
+        size_t count = 0;
+
+        for (int r = row; r < row + height; r++) {
+                for (int c = col; c < col + width; c++) {
+                        count += pixels.at[r * pixels.width + c];
+                }
+        }
+
+        return count;
+}
+
+/******** check_algebra ********
+ *
+ * Check Bit2_combine, the set operations and Bit2_invert against the same
+ * operations done on single pixels
+ *
+ * Parameters:
+ *      int width, height:      size of the bitmaps
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if every result holds the expected pixels and clear padding
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      Bit2_union, Bit2_inter, Bit2_minus and Bit2_diff are checked
+ *      against the Bit2_op they should match.
+ ************************/
+bool check_algebra(int width, int height, uint64_t *state)
+{
+        static const Bit2_op ops[] = { BIT2_OR, BIT2_AND, BIT2_MINUS,
+                                       BIT2_XOR };
+        Bit2_T (*makers[])(Bit2_T, Bit2_T) = { Bit2_union, Bit2_inter,
+                                               Bit2_minus, Bit2_diff };
+        Pixels s = new_pixels(width, height);
+        Pixels t = new_pixels(width, height);
+        Pixels expected = new_pixels(width, height);
+        Bit2_T s_bitmap = make_image(s, state);
+        Bit2_T t_bitmap = make_image(t, state);
+        size_t npixels = (size_t) width * height;
+        bool ok = true;
+
+        for (int i = 0; i < 4; i++) {
+                Bit2_T combined = to_bitmap(s);
+                Bit2_T made = makers[i](s_bitmap, t_bitmap);
+
+                for (size_t p = 0; p < npixels; p++) {
+                        expected.at[p] = apply_op(ops[i], s.at[p], t.at[p]);
+                }
+                Bit2_combine(combined, t_bitmap, ops[i]);
+                ok = ok && same(combined, expected) && same(made, expected);
+
+                Bit2_free(&combined);
+                Bit2_free(&made);
+        }
+
+        for (size_t p = 0; p < npixels; p++) {
+                expected.at[p] = !s.at[p];
+        }
+        Bit2_invert(s_bitmap);
+        ok = ok && same(s_bitmap, expected);
+
+        Bit2_free(&s_bitmap);
+        Bit2_free(&t_bitmap);
+        free_pixels(&s);
+        free_pixels(&t);
+        free_pixels(&expected);
+
+        return ok;
+}
+
+/******** check_rects ********
+ *
+ * Check Bit2_invert_rect and Bit2_combine_rect against the same changes
+ * made to single pixels
+ *
+ * Parameters:
+ *      int width, height:      size of the bitmaps
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if the bitmaps hold the expected pixels and clear padding
+ *      after every change
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      Each combined rectangle is taken from a random place in the source
+ *      and put at another in the destination, so the two usually start at
+ *      different bit offsets within their words.
+ ************************/
+bool check_rects(int width, int height, uint64_t *state)
+{
+        Pixels dst = new_pixels(width, height);
+        Pixels src = new_pixels(width, height);
+        Bit2_T dst_bitmap = make_image(dst, state);
+        Bit2_T src_bitmap = make_image(src, state);
+        bool ok = true;
+
+        for (int i = 0; i < 40 && width > 0 && height > 0; i++) {
+                int w = (int) (next_random(state) % (uint64_t) (width + 1));
+                int h = (int) (next_random(state) % (uint64_t) (height + 1));
+                int col = (int) (next_random(state) %
+                                 (uint64_t) (width - w + 1));
+                int row = (int) (next_random(state) %
+                                 (uint64_t) (height - h + 1));
+                int src_col = (int) (next_random(state) %
+                                     (uint64_t) (width - w + 1));
+                int src_row = (int) (next_random(state) %
+                                     (uint64_t) (height - h + 1));
+                Bit2_op op = (Bit2_op) (next_random(state) % 4);
+
+                if (i % 2 == 0) {
+                        Bit2_invert_rect(dst_bitmap, col, row, w, h);
+                } else {
+                        Bit2_combine_rect(dst_bitmap, col, row, src_bitmap,
+                                          src_col, src_row, w, h, op);
+                }
+                for (int r = 0; r < h; r++) {
+                        for (int c = 0; c < w; c++) {
+                                unsigned char *d = &dst.at[(row + r) * width +
+                                                           col + c];
+                                int sp = src.at[(src_row + r) * width +
+                                                src_col + c];
+
+                                *d = i % 2 == 0 ? !*d :
+                                                  apply_op(op, *d, sp);
+                        }
+                }
+                ok = ok && same(dst_bitmap, dst);
+        }
+
+        Bit2_free(&dst_bitmap);
+        Bit2_free(&src_bitmap);
+        free_pixels(&dst);
+        free_pixels(&src);
+
+        return ok;
+}
+
+/******** apply_op ********
+ *
+ * Combine two single pixels
+ *
+ * Parameters:
+ *      Bit2_op op:     the operation
+ *      int dst, src:   the pixels, each 0 or 1
+ * Return:
+ *      dst op src, as Bit2_combine defines it
+ * Expects:
+ *      op is one of the Bit2_op values. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int apply_op(Bit2_op op, int dst, int src)
+{
+        switch (op) {
+        case BIT2_AND:
+                return dst && src;
+        case BIT2_OR:
+                return dst || src;
+        case BIT2_XOR:
+                return dst != src;
+        case BIT2_MINUS:
+                return dst && !src;
+        }
+        assert(false);
+
+        return 0;
+}
+
+/******** check_maps ********
+ *
+ * Check that Bit2_map_set and Bit2_map_clear visit exactly the 1 and 0
+ * pixels, in row-major order
+ *
+ * Parameters:
+ *      int width, height:      size of the bitmap
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if each map visits every pixel of its value once, in order,
+ *      and nothing else
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      The images are noise, a few scattered 1s, and all 1s, so that both
+ *      maps skip whole words as well as pick bits out of mixed ones. A map
+ *      over 0s must not visit the padding.
+ ************************/
+bool check_maps(int width, int height, uint64_t *state)
+{
+        Pixels pixels = new_pixels(width, height);
+        size_t npixels = (size_t) width * height;
+        bool ok = true;
+
+        for (int pass = 0; pass < 3; pass++) {
+                Bit2_T bitmap = make_image(pixels, state);
+
+                for (size_t p = 0; p < npixels && pass > 0; p++) {
+                        pixels.at[p] = pass == 2 ||
+                                       next_random(state) % 50 == 0;
+                        Bit2_put(bitmap, (int) (p % width),
+                                 (int) (p / width), pixels.at[p]);
+                }
+
+                size_t ones = count_pixels(pixels, 0, 0, width, height);
+                Visits set = { pixels, 1, 0, 0, -1, true };
+                Visits clear = { pixels, 0, 0, 0, -1, true };
+
+                Bit2_map_set(bitmap, check_visit, &set);
+                Bit2_map_clear(bitmap, check_visit, &clear);
+                ok = ok && set.ok && set.count == ones && clear.ok &&
+                     clear.count == npixels - ones;
+
+                Bit2_free(&bitmap);
+        }
+
+        free_pixels(&pixels);
+
+        return ok;
+}
+
+/******** check_visit ********
+ *
+ * Sparse map apply function: check one visited pixel against the ones
+ * before it
+ *
+ * Parameters:
+ *      int col, row:   position of the pixel
+ *      Bit2_T bitmap:  the bitmap being mapped
+ *      int bit:        the value the map says it has
+ *      void *cl:       the Visits so far
+ * Return:
+ *      nothing; clears visits->ok on any mismatch
+ * Expects:
+ *      cl is not NULL
+ * Notes:
+ *      Visits must move forward by (row, col), which together with the
+ *      final count means every pixel of the value was visited once.
+ ************************/
+void check_visit(int col, int row, Bit2_T bitmap, int bit, void *cl)
+{
+        Visits *visits = cl;
+        Pixels pixels = visits->pixels;
+        bool in_range = 0 <= col && col < pixels.width && 0 <= row &&
+                        row < pixels.height;
+        bool forward = row > visits->last_row ||
+                       (row == visits->last_row && col > visits->last_col);
+
+        if (!in_range || !forward || bit != visits->bit ||
+            Bit2_get(bitmap, col, row) != bit ||
+            pixels.at[row * pixels.width + col] != bit) {
+                visits->ok = false;
+        }
+
+        visits->count++;
+        visits->last_col = col;
+        visits->last_row = row;
+}
+
+/******** same ********
+ *
+ * Whether a bitmap holds exactly the given pixels
+ *
+ * Parameters:
+ *      Bit2_T bitmap:  the bitmap
+ *      Pixels pixels:  the pixels it should hold
+ * Return:
+ *      true if the sizes match, every Bit2_get matches its pixel, and the
+ *      padding is clear
+ * Expects:
+ *      bitmap is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool same(Bit2_T bitmap, Pixels pixels)
+{
+        bool ok = Bit2_width(bitmap) == pixels.width &&
+                  Bit2_height(bitmap) == pixels.height;
+
+        for (int row = 0; row < pixels.height && ok; row++) {
+                for (int col = 0; col < pixels.width && ok; col++) {
+                        ok = Bit2_get(bitmap, col, row) ==
+                             pixels.at[row * pixels.width + col];
+                }
+        }
+
+        return ok && padding_clear(bitmap);
+}
+
+/******** padding_clear ********
+ *
+ * Whether the bits past the width in every row's last word are 0
+ *
+ * Parameters:
+ *      Bit2_T bitmap:  the bitmap
+ * Return:
+ *      true if no padding bit is set
+ * Expects:
+ *      bitmap is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      A width that is a multiple of 64 has no padding.
+ ************************/
+bool padding_clear(Bit2_T bitmap)
+{
+        int width = Bit2_width(bitmap);
+        int last = Bit2_words_per_row(bitmap) - 1;
+
+        if (width % 64 == 0) {
+                return true;
+        }
+        for (int row = 0; row < Bit2_height(bitmap); row++) {
+                if (Bit2_get_word(bitmap, last, row) >> (width % 64) != 0) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+/******** make_image ********
+ *
+ * Fill an image with noise and build the same image as a bitmap
+ *
+ * Parameters:
+ *      Pixels pixels:          the image, overwritten
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      a new bitmap holding the same pixels
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      The bitmap is built with Bit2_put, one pixel at a time, so that it
+ *      shares nothing with the word-at-a-time code under test.
+ ************************/
+Bit2_T make_image(Pixels pixels, uint64_t *state)
+{
+        for (int row = 0; row < pixels.height; row++) {
+                for (int col = 0; col < pixels.width; col++) {
+                        pixels.at[row * pixels.width + col] =
+                                next_random(state) & 1;
+                }
+        }
+
+        return to_bitmap(pixels);
+}
+
+/******** to_bitmap ********
+ *
+ * Build a bitmap holding an image's pixels
+ *
+ * Parameters:
+ *      Pixels pixels:  the image
+ * Return:
+ *      a new bitmap, built one pixel at a time with Bit2_put
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      none
+ ************************/
+Bit2_T to_bitmap(Pixels pixels)
+{
+        Bit2_T bitmap = Bit2_new(pixels.width, pixels.height);
+
+        for (int row = 0; row < pixels.height; row++) {
+                for (int col = 0; col < pixels.width; col++) {
+                        Bit2_put(bitmap, col, row,
+                                 pixels.at[row * pixels.width + col]);
+                }
+        }
+
+        return bitmap;
+}
+
+/******** pixel_word ********
+ *
+ * Gather 64 pixels into a word, the way Bit2 lays them out
+ *
+ * Parameters:
+ *      Pixels pixels:  the pixels
+ *      int word, row:  which word of which row
+ * Return:
+ *      column 64 * word in the least significant bit, with columns past
+ *      the width as 0
+ * Expects:
+ *      the word and row are in range
+ * Notes:
+ *      none
+ ************************/
+uint64_t pixel_word(Pixels pixels, int word, int row)
+{
+        uint64_t bits = 0;
+
+        for (int i = 0; i < 64 && 64 * word + i < pixels.width; i++) {
+                uint64_t pixel = pixels.at[row * pixels.width + 64 * word +
+                                           i];
+
+                bits |= pixel << i;
+        }
+
+        return bits;
+}
+
+/******** put_pixel_word ********
+ *
+ * Spread a word over 64 pixels, the way Bit2 lays them out
+ *
+ * Parameters:
+ *      Pixels pixels:  the pixels, changed
+ *      int word, row:  which word of which row
+ *      uint64_t bits:  column 64 * word in the least significant bit
+ * Return:
+ *      nothing
+ * Expects:
+ *      the word and row are in range
+ * Notes:
+ *      Bits for columns past the width are dropped.
+ ************************/
+void put_pixel_word(Pixels pixels, int word, int row, uint64_t bits)
+{
+        for (int i = 0; i < 64 && 64 * word + i < pixels.width; i++) {
+                pixels.at[row * pixels.width + 64 * word + i] =
+                        (bits >> i) & 1;
+        }
+}
+
+/******** new_pixels ********
+ *
+ * Make an all-0 image of single pixels
+ *
+ * Parameters:
+ *      int width, height:      size of the image
+ * Return:
+ *      the image, which the caller frees with free_pixels
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      none
+ ************************/
+Pixels new_pixels(int width, int height)
+{
+        Pixels pixels = { width, height,
+                          calloc((size_t) width * height + 1, 1) };
+
+        assert(pixels.at != NULL);
+
+        return pixels;
+}
+
+/******** free_pixels ********
+ *
+ * Free an image made by new_pixels
+ *
+ * Parameters:
+ *      Pixels *pixels: the image; its pointer is set to NULL
+ * Return:
+ *      nothing
+ * Expects:
+ *      pixels is not NULL
+ * Notes:
+ *      none
+ ************************/
+void free_pixels(Pixels *pixels)
+{
+        free(pixels->at);
+        pixels->at = NULL;
+}
+
+/******** next_random ********
+ *
+ * Step a xorshift64 generator
+ *
+ * Parameters:
+ *      uint64_t *state:        generator state, never 0
+ * Return:
+ *      the next 64 random bits
+ * Expects:
+ *      state is not NULL
+ * Notes:
+ *      none
+ ************************/
+uint64_t next_random(uint64_t *state)
+{
+        uint64_t x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+
+        return x;
+}
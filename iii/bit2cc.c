@@ -0,0 +1,443 @@
+/*
+ *      bit2cc.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of multithreaded connected components on Bit2
+ *      bitmaps. Components are built from horizontal black runs: every run
+ *      gets a label (its index in one shared array, in row-major order), and
+ *      runs in adjacent rows whose columns overlap are joined. The work is
+ *      done in phases, each run by every band at once:
+ *
+ *          count   each band counts its runs, so labels can be handed out
+ *          label   each band records its runs and joins them within itself
+ *          seam    each band joins its first row to the band above's last
+ *          mark    runs on the border flag their component's root
+ *          clear   runs whose root is flagged are whitened
+ *
+ *      Bands are whole rows, and Bit2 rows never share a word, so no two
+ *      threads ever write the same word of the bitmap.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdint.h>
+#include "bit2cc.h"
+#include "assert.h"
+
+/* One horizontal run of black pixels, columns [start, end) of a row */
+typedef struct run {
+        int row;
+        int start;
+        int end;
+} Run;
+
+/* Per-run arrays shared by every band, indexed by label */
+typedef struct labels {
+        Run *runs;
+        uint32_t *parent;
+        unsigned char *border;
+} Labels;
+
+/* One worker's share: a band of rows [first, last) and its runs */
+typedef struct band {
+        Bit2_T bitmap;
+        int first;
+        int last;
+        size_t base;
+        size_t count;
+        Labels *labels;
+        struct band *above;
+        pthread_t thread;
+} Band;
+
+static void run_phase(Band *bands, int nbands, void *phase(void *));
+static void *count_band(void *band_vp);
+static void *label_band(void *band_vp);
+static void *join_seam(void *band_vp);
+static void *mark_border(void *band_vp);
+static void *clear_band(void *band_vp);
+static void join_rows(Labels *labels, size_t above, size_t above_end,
+                      size_t below, size_t below_end);
+static uint32_t find_root(uint32_t *parent, uint32_t label);
+static void join(uint32_t *parent, uint32_t a, uint32_t b);
+
+/******** Bit2cc_clear_border ********
+ *
+ * Whiten every black pixel that is 4-connected to a black border pixel
+ *
+ * Parameters:
+ *      Bit2_T bitmap:  the bitmap to clean, changed in place
+ *      int nthreads:   requested worker count, <= 0 for one per processor
+ * Return:
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE otherwise, if malloc or pthread_create fails, or if the
+ *      bitmap has UINT32_MAX or more black runs
+ * Notes:
+ *      Between the count and label phases the calling thread hands out
+ *      each band's first label and allocates the shared arrays.
+ ************************/
+void Bit2cc_clear_border(Bit2_T bitmap, int nthreads)
+{
+        assert(bitmap != NULL);
+
+        int height = Bit2_height(bitmap);
+
+        if (nthreads <= 0) {
+                nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if (nthreads > height) {
+                nthreads = height;
+        }
+        if (nthreads < 1 || Bit2_width(bitmap) == 0) {
+                return;
+        }
+
+        Band *bands = malloc(nthreads * sizeof(*bands));
+        assert(bands != NULL);
+        Labels labels = { NULL, NULL, NULL };
+
+        for (int i = 0; i < nthreads; i++) {
+                bands[i].bitmap = bitmap;
+                bands[i].first = (int) ((long) height * i / nthreads);
+                bands[i].last = (int) ((long) height * (i + 1) / nthreads);
+                bands[i].labels = &labels;
+                bands[i].above = i > 0 ? &bands[i - 1] : NULL;
+        }
+
+        run_phase(bands, nthreads, count_band);
+
+        size_t total = 0;
+        for (int i = 0; i < nthreads; i++) {
+                bands[i].base = total;
+                total += bands[i].count;
+        }
+        assert(total < UINT32_MAX);
+
+        labels.runs = malloc((total + 1) * sizeof(Run));
+        labels.parent = malloc((total + 1) * sizeof(uint32_t));
+        labels.border = calloc(total + 1, 1);
+        assert(labels.runs != NULL && labels.parent != NULL &&
+               labels.border != NULL);
+
+        run_phase(bands, nthreads, label_band);
+        run_phase(bands, nthreads, join_seam);
+        run_phase(bands, nthreads, mark_border);
+        run_phase(bands, nthreads, clear_band);
+
+        free(labels.runs);
+        free(labels.parent);
+        free(labels.border);
+        free(bands);
+}
+
+/******** run_phase ********
+ *
+ * Run one phase on every band at once, and wait for all of them
+ *
+ * Parameters:
+ *      Band *bands:    the bands
+ *      int nbands:     how many bands
+ *      void *phase:    thread body, given a Band
+ * Return:
+ *      nothing
+ * Expects:
+ *      Throws CRE if pthread_create fails
+ * Notes:
+ *      The calling thread does band 0 itself. Joining every thread is the
+ *      barrier between phases.
+ ************************/
+static void run_phase(Band *bands, int nbands, void *phase(void *))
+{
+        for (int i = 1; i < nbands; i++) {
+                int err = pthread_create(&bands[i].thread, NULL, phase,
+                                         &bands[i]);
+                assert(err == 0);
+        }
+        phase(&bands[0]);
+
+        for (int i = 1; i < nbands; i++) {
+                pthread_join(bands[i].thread, NULL);
+        }
+}
+
+/******** count_band ********
+ *
+ * Count phase: count the black runs in a band's rows
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL; the band's count is filled in
+ * Notes:
+ *      Run ends are found a word at a time with Bit2_next.
+ ************************/
+static void *count_band(void *band_vp)
+{
+        Band *band = band_vp;
+        Bit2_T bitmap = band->bitmap;
+        size_t count = 0;
+
+        for (int row = band->first; row < band->last; row++) {
+                int col = Bit2_next(bitmap, 0, row, 1);
+
+                while (col < Bit2_width(bitmap)) {
+                        col = Bit2_next(bitmap, Bit2_next(bitmap, col, row, 0),
+                                        row, 1);
+                        count++;
+                }
+        }
+
+        band->count = count;
+
+        return NULL;
+}
+
+/******** label_band ********
+ *
+ * Label phase: record a band's runs and join those that touch within it
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL
+ * Notes:
+ *      The band only writes its own slice of the shared arrays.
+ ************************/
+static void *label_band(void *band_vp)
+{
+        Band *band = band_vp;
+        Bit2_T bitmap = band->bitmap;
+        Labels *labels = band->labels;
+        size_t next = band->base;
+        size_t above = next;
+
+        for (int row = band->first; row < band->last; row++) {
+                size_t row_start = next;
+                int col = Bit2_next(bitmap, 0, row, 1);
+
+                while (col < Bit2_width(bitmap)) {
+                        int end = Bit2_next(bitmap, col, row, 0);
+                        Run run = { row, col, end };
+
+                        labels->runs[next] = run;
+                        labels->parent[next] = (uint32_t) next;
+                        next++;
+                        col = Bit2_next(bitmap, end, row, 1);
+                }
+
+                join_rows(labels, above, row_start, row_start, next);
+                above = row_start;
+        }
+
+        return NULL;
+}
+
+/******** join_seam ********
+ *
+ * Seam phase: join a band's first row with the last row of the band above
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL
+ * Notes:
+ *      Every seam is joined at the same time; join is safe to race.
+ ************************/
+static void *join_seam(void *band_vp)
+{
+        Band *band = band_vp;
+        Band *upper = band->above;
+        Labels *labels = band->labels;
+
+        if (upper == NULL) {
+                return NULL;
+        }
+
+        size_t upper_end = upper->base + upper->count;
+        size_t above = upper_end;
+        while (above > upper->base &&
+               labels->runs[above - 1].row == band->first - 1) {
+                above--;
+        }
+
+        size_t below_end = band->base;
+        while (below_end < band->base + band->count &&
+               labels->runs[below_end].row == band->first) {
+                below_end++;
+        }
+
+        join_rows(labels, above, upper_end, band->base, below_end);
+
+        return NULL;
+}
+
+/******** mark_border ********
+ *
+ * Mark phase: flag the component of every run that touches the border
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL
+ * Notes:
+ *      Several bands may flag the same root; every store writes 1.
+ ************************/
+static void *mark_border(void *band_vp)
+{
+        Band *band = band_vp;
+        Labels *labels = band->labels;
+        int width = Bit2_width(band->bitmap);
+        int height = Bit2_height(band->bitmap);
+
+        for (size_t i = band->base; i < band->base + band->count; i++) {
+                Run *run = &labels->runs[i];
+
+                if (run->row == 0 || run->row == height - 1 ||
+                    run->start == 0 || run->end == width) {
+                        uint32_t root = find_root(labels->parent,
+                                                  (uint32_t) i);
+                        __atomic_store_n(&labels->border[root], 1,
+                                         __ATOMIC_RELAXED);
+                }
+        }
+
+        return NULL;
+}
+
+/******** clear_band ********
+ *
+ * Clear phase: whiten a band's runs whose component touches the border
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL
+ * Notes:
+ *      Runs are whitened a word at a time with Bit2_fill_rect.
+ ************************/
+static void *clear_band(void *band_vp)
+{
+        Band *band = band_vp;
+        Labels *labels = band->labels;
+
+        for (size_t i = band->base; i < band->base + band->count; i++) {
+                Run *run = &labels->runs[i];
+                uint32_t root = find_root(labels->parent, (uint32_t) i);
+
+                if (__atomic_load_n(&labels->border[root], __ATOMIC_RELAXED)) {
+                        Bit2_fill_rect(band->bitmap, run->start, run->row,
+                                       run->end - run->start, 1, 0);
+                }
+        }
+
+        return NULL;
+}
+
+/******** join_rows ********
+ *
+ * Join every pair of runs, one from each of two adjacent rows, whose
+ * columns overlap
+ *
+ * Parameters:
+ *      Labels *labels:                 the shared arrays
+ *      size_t above, above_end:        labels of the upper row's runs
+ *      size_t below, below_end:        labels of the lower row's runs
+ * Return:
+ *      nothing
+ * Notes:
+ *      Both rows are in order, so one forward walk over the upper row
+ *      finds every overlap. An empty range joins nothing.
+ ************************/
+static void join_rows(Labels *labels, size_t above, size_t above_end,
+                      size_t below, size_t below_end)
+{
+        Run *runs = labels->runs;
+
+        for (size_t k = below; k < below_end; k++) {
+                while (above < above_end && runs[above].end <= runs[k].start) {
+                        above++;
+                }
+                for (size_t j = above; j < above_end &&
+                     runs[j].start < runs[k].end; j++) {
+                        join(labels->parent, (uint32_t) j, (uint32_t) k);
+                }
+        }
+}
+
+/******** find_root ********
+ *
+ * Find the root label of a component, safe to run alongside join
+ *
+ * Parameters:
+ *      uint32_t *parent:       the shared parent array
+ *      uint32_t label:         any label in the component
+ * Return:
+ *      the component's root at the time of the call
+ * Notes:
+ *      Path halving with a compare-and-swap: a label is only ever pointed
+ *      further up its own tree, so a lost race just skips the shortcut.
+ ************************/
+static uint32_t find_root(uint32_t *parent, uint32_t label)
+{
+        for (;;) {
+                uint32_t up = __atomic_load_n(&parent[label],
+                                              __ATOMIC_ACQUIRE);
+                if (up == label) {
+                        return label;
+                }
+
+                uint32_t next = __atomic_load_n(&parent[up],
+                                                __ATOMIC_ACQUIRE);
+                if (next != up) {
+                        __atomic_compare_exchange_n(&parent[label], &up,
+                                                    next, true,
+                                                    __ATOMIC_RELEASE,
+                                                    __ATOMIC_RELAXED);
+                }
+                label = next;
+        }
+}
+
+/******** join ********
+ *
+ * Merge the components of two labels, safe to run alongside other joins
+ *
+ * Parameters:
+ *      uint32_t *parent:       the shared parent array
+ *      uint32_t a, b:          labels to merge
+ * Return:
+ *      nothing
+ * Notes:
+ *      The larger root is linked under the smaller with a compare-and-swap
+ *      that only succeeds while it is still a root; otherwise another
+ *      thread linked it first and the roots are found again. Linking in
+ *      label order means no cycle can form.
+ ************************/
+static void join(uint32_t *parent, uint32_t a, uint32_t b)
+{
+        for (;;) {
+                a = find_root(parent, a);
+                b = find_root(parent, b);
+                if (a == b) {
+                        return;
+                }
+                if (a < b) {
+                        uint32_t swap = a;
+                        a = b;
+                        b = swap;
+                }
+
+                uint32_t expected = a;
+                if (__atomic_compare_exchange_n(&parent[a], &expected, b,
+                                                false, __ATOMIC_ACQ_REL,
+                                                __ATOMIC_ACQUIRE)) {
+                        return;
+                }
+        }
+}
@@ -0,0 +1,43 @@
+/*
+ *      bit2cc.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Interface for multithreaded connected components on Bit2 bitmaps.
+ *      The bitmap is split into bands of rows; each thread labels the black
+ *      runs of its own band, then the threads join labels across the seams
+ *      between bands with a lock-free union-find.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "bit2.h"
+
+#ifndef BIT2CC_INCLUDED
+#define BIT2CC_INCLUDED
+
+/******** Bit2cc_clear_border ********
+ *
+ * Whiten every black pixel that is 4-connected, through black pixels, to a
+ * black pixel on the border of the bitmap
+ *
+ * Parameters:
+ *      Bit2_T bitmap:  the bitmap to clean, changed in place
+ *      int nthreads:   requested worker count, <= 0 for one per processor
+ * Return:
+ *      Nothing
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE otherwise, if malloc or pthread_create fails, or if the
+ *      bitmap has UINT32_MAX or more black runs
+ * Notes:
+ *      The result does not depend on nthreads, and is the same as a serial
+ *      flood fill from every black border pixel. Workers never outnumber
+ *      rows, and the calling thread does the first band's share itself.
+ *      Needs GCC-style __atomic builtins.
+ ************************/
+void Bit2cc_clear_border(Bit2_T bitmap, int nthreads);
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ *      bit2cc_bench.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Benchmark for the threaded border clean, Bit2cc_clear_border, on a
+ *      large synthetic scan: half-density noise crossed by long black bars,
+ *      so plenty of components span the seams between bands. The thread
+ *      count doubles from 1 up to the maximum, and every result is checked
+ *      against the serial Bit2_reconstruct clean.
+ *
+ *      Usage: bit2cc_bench [width height [maxthreads]]
+ *      Defaults to a 10000 x 10000 image (10^8 pixels) and one thread per
+ *      online processor.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include <unistd.h>
+#include <stdint.h>
+#include "bit2.h"
+#include "bit2cc.h"
+#include "assert.h"
+
+/* Long bars drawn over the noise, half across and half down */
+#define BARS 400
+
+Bit2_T make_image(int width, int height);
+uint64_t next_random(uint64_t *state);
+Bit2_T reference_clean(Bit2_T image);
+double seconds_since(struct timespec start);
+
+/******** main ********
+ *
+ * Time the border clean at each thread count and print the results
+ *
+ * Parameters:
+ *      int argc:       argument count
+ *      char *argv[]:   optional width, height, and maximum thread count
+ * Return:
+ *      0 if every thread count matched the serial clean
+ * Expects:
+ *      argc is 1, 3, or 4. Throws CRE otherwise.
+ * Notes:
+ *      Each run cleans a fresh copy of the same image.
+ ************************/
+int main(int argc, char *argv[])
+{
+        assert(argc == 1 || argc == 3 || argc == 4);
+
+        int width = argc > 1 ? atoi(argv[1]) : 10000;
+        int height = argc > 1 ? atoi(argv[2]) : 10000;
+        int maxthreads = argc > 3 ? atoi(argv[3]) : 0;
+        if (maxthreads <= 0) {
+                maxthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        }
+
+        Bit2_T image = make_image(width, height);
+        struct timespec start;
+        int status = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        Bit2_T expected = reference_clean(image);
+        double serial = seconds_since(start);
+
+        printf("%d x %d pixels, %zu black, %zu left after cleaning\n",
+               width, height, Bit2_count(image), Bit2_count(expected));
+        printf("serial reconstruct:  %8.3f s\n", serial);
+
+        double one_thread = 0;
+        /* Double up to the maximum, and end on it even if not a power of 2 */
+        for (int nthreads = 1; nthreads <= maxthreads;
+             nthreads = nthreads < maxthreads && nthreads * 2 > maxthreads ?
+                        maxthreads : nthreads * 2) {
+                Bit2_T cleaned = Bit2_union(image, image);
+
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                Bit2cc_clear_border(cleaned, nthreads);
+                double seconds = seconds_since(start);
+
+                if (nthreads == 1) {
+                        one_thread = seconds;
+                }
+
+                Bit2_T diff = Bit2_diff(cleaned, expected);
+                bool same = Bit2_count(diff) == 0;
+                printf("%3d thread(s):       %8.3f s  (x%.2f)%s\n", nthreads,
+                       seconds, one_thread / seconds,
+                       same ? "" : "  MISMATCH");
+                if (!same) {
+                        status = EXIT_FAILURE;
+                }
+
+                Bit2_free(&diff);
+                Bit2_free(&cleaned);
+        }
+
+        Bit2_free(&expected);
+        Bit2_free(&image);
+
+        return status;
+}
+
+/******** make_image ********
+ *
+ * Build the synthetic scan
+ *
+ * Parameters:
+ *      int width, height:      size of the image
+ * Return:
+ *      a new bitmap of half-density noise crossed by BARS black bars
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      The seed is fixed, so every run sees the same image. Noise is laid
+ *      down a word at a time; Bit2_put_word keeps the row padding zero.
+ ************************/
+Bit2_T make_image(int width, int height)
+{
+        Bit2_T image = Bit2_new(width, height);
+        int words = Bit2_words_per_row(image);
+        uint64_t state = 0x9e3779b97f4a7c15u;
+
+        for (int row = 0; row < height; row++) {
+                for (int word = 0; word < words; word++) {
+                        Bit2_put_word(image, word, row,
+                                      next_random(&state));
+                }
+        }
+
+        for (int i = 0; i < BARS && width > 0 && height > 0; i++) {
+                int col = (int) (next_random(&state) % (uint64_t) width);
+                int row = (int) (next_random(&state) % (uint64_t) height);
+
+                if (i % 2 == 0) {
+                        Bit2_fill_rect(image, 0, row, width - col, 1, 1);
+                } else {
+                        Bit2_fill_rect(image, col, 0, 1, height - row, 1);
+                }
+        }
+
+        return image;
+}
+
+/******** next_random ********
+ *
+ * Step a xorshift64 generator
+ *
+ * Parameters:
+ *      uint64_t *state:        generator state, never 0
+ * Return:
+ *      the next 64 random bits
+ * Expects:
+ *      state is not NULL
+ * Notes:
+ *      none
+ ************************/
+uint64_t next_random(uint64_t *state)
+{
+        uint64_t x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+
+        return x;
+}
+
+/******** reference_clean ********
+ *
+ * Clean a copy of the image serially, for checking the threaded clean
+ *
+ * Parameters:
+ *      Bit2_T image:   the image, left alone
+ * Return:
+ *      a new bitmap: image with every border-connected black pixel whitened
+ * Expects:
+ *      image is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Same approach as unblackedges --propagate: grow the black border
+ *      pixels inside the image, then take them away from it.
+ ************************/
+Bit2_T reference_clean(Bit2_T image)
+{
+        int width = Bit2_width(image);
+        int height = Bit2_height(image);
+        Bit2_T marker = Bit2_new(width, height);
+
+        if (width > 0 && height > 0) {
+                Bit2_fill_rect(marker, 0, 0, width, 1, 1);
+                Bit2_fill_rect(marker, 0, height - 1, width, 1, 1);
+                Bit2_fill_rect(marker, 0, 0, 1, height, 1);
+                Bit2_fill_rect(marker, width - 1, 0, 1, height, 1);
+        }
+        Bit2_combine(marker, image, BIT2_AND);
+        Bit2_reconstruct(marker, image);
+
+        Bit2_T cleaned = Bit2_minus(image, marker);
+        Bit2_free(&marker);
+
+        return cleaned;
+}
+
+/******** seconds_since ********
+ *
+ * Return the wall-clock seconds elapsed since start
+ *
+ * Parameters:
+ *      struct timespec start:  time the measurement began
+ * Return:
+ *      elapsed seconds
+ * Expects:
+ *      none
+ * Notes:
+ *      none
+ ************************/
+double seconds_since(struct timespec start)
+{
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        return (end.tv_sec - start.tv_sec) +
+               (end.tv_nsec - start.tv_nsec) / 1e9;
+}
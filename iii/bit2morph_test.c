@@ -0,0 +1,179 @@
+/*
+ *      bit2morph_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Test for Bit2_morph opening and closing. For any structuring element,
+ *      the opening of an image is a subset of the image and the image is a
+ *      subset of its closing. Even widths and heights put the anchor off
+ *      centre, which is where a missing reflection would show up, so the
+ *      elements tried include those alongside the odd ones.
+ *
+ *      Usage: bit2morph_test
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#include <stdint.h>
+#include "bit2.h"
+#include "assert.h"
+
+/* Random images tried for every element */
+#define IMAGES 20
+
+Bit2_T make_image(int width, int height, uint64_t *state);
+uint64_t next_random(uint64_t *state);
+bool is_subset(Bit2_T s, Bit2_T t);
+bool check_element(Bit2_T image, Bit2_element element);
+
+/******** main ********
+ *
+ * Open and close random images by each test element and check the results
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every opening and closing held, EXIT_FAILURE otherwise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      Image sizes vary so that rows end both on and off a word boundary.
+ ************************/
+int main(void)
+{
+        static const Bit2_element elements[] = {
+                { 2, 2, false }, { 4, 3, false }, { 2, 5, false },
+                { 3, 4, false }, { 6, 6, false }, { 1, 2, false },
+                { 2, 1, false }, { 3, 3, false }, { 5, 1, false },
+                { 2, 2, true },  { 4, 3, true },  { 3, 3, true }
+        };
+        int nelements = sizeof(elements) / sizeof(elements[0]);
+        uint64_t state = 0x9e3779b97f4a7c15u;
+        int failures = 0;
+
+        for (int i = 0; i < IMAGES; i++) {
+                int width = 1 + (int) (next_random(&state) % 150);
+                int height = 1 + (int) (next_random(&state) % 40);
+                Bit2_T image = make_image(width, height, &state);
+
+                for (int e = 0; e < nelements; e++) {
+                        if (!check_element(image, elements[e])) {
+                                printf("FAIL: %d x %d image, element "
+                                       "{%d, %d, %s}\n", width, height,
+                                       elements[e].width, elements[e].height,
+                                       elements[e].cross ? "true" : "false");
+                                failures++;
+                        }
+                }
+
+                Bit2_free(&image);
+        }
+
+        printf("bit2morph_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_element ********
+ *
+ * Check that opening by an element shrinks an image and closing grows it
+ *
+ * Parameters:
+ *      Bit2_T image:           the image, left alone
+ *      Bit2_element element:   the structuring element
+ * Return:
+ *      true if open(image) is a subset of image and image is a subset of
+ *      close(image)
+ * Expects:
+ *      image is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool check_element(Bit2_T image, Bit2_element element)
+{
+        Bit2_T opened = Bit2_morph(image, BIT2_OPEN, element);
+        Bit2_T closed = Bit2_morph(image, BIT2_CLOSE, element);
+        bool ok = is_subset(opened, image) && is_subset(image, closed);
+
+        Bit2_free(&opened);
+        Bit2_free(&closed);
+
+        return ok;
+}
+
+/******** is_subset ********
+ *
+ * Whether every 1 of one bitmap is also a 1 of another
+ *
+ * Parameters:
+ *      Bit2_T s, t:    bitmaps of the same size
+ * Return:
+ *      true if s has no 1 that t lacks
+ * Expects:
+ *      s and t are not NULL and are the same size. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool is_subset(Bit2_T s, Bit2_T t)
+{
+        Bit2_T extra = Bit2_minus(s, t);
+        bool subset = Bit2_count(extra) == 0;
+
+        Bit2_free(&extra);
+
+        return subset;
+}
+
+/******** make_image ********
+ *
+ * Build a random test image
+ *
+ * Parameters:
+ *      int width, height:      size of the image
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      a new bitmap of half-density noise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      Noise is laid down a word at a time; Bit2_put_word keeps the row
+ *      padding zero.
+ ************************/
+Bit2_T make_image(int width, int height, uint64_t *state)
+{
+        Bit2_T image = Bit2_new(width, height);
+        int words = Bit2_words_per_row(image);
+
+        for (int row = 0; row < height; row++) {
+                for (int word = 0; word < words; word++) {
+                        Bit2_put_word(image, word, row, next_random(state));
+                }
+        }
+
+        return image;
+}
+
+/******** next_random ********
+ *
+ * Step a xorshift64 generator
+ *
+ * Parameters:
+ *      uint64_t *state:        generator state, never 0
+ * Return:
+ *      the next 64 random bits
+ * Expects:
+ *      state is not NULL
+ * Notes:
+ *      none
+ ************************/
+uint64_t next_random(uint64_t *state)
+{
+        uint64_t x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+
+        return x;
+}
@@ -0,0 +1,385 @@
+/*
+ *      bit2rle.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of run-length-compressed two-dimensional bit arrays.
+ *      Each row is a list of run ends: the first run of a row is always 0
+ *      (white) and runs alternate from there, so the k-th run of a row has
+ *      value k % 2. A row that starts black begins with an empty white run.
+ *      The header, the per-row offsets and the run ends share one block.
+ */
+
+#include <stdint.h>
+#include "bit2rle.h"
+#include "assert.h"
+
+#define T Bit2rle_T
+
+struct T
+{
+        int width;
+        int height;
+        size_t runs;
+        size_t bytes;
+        size_t *row_start;      /* row r's ends are ends[row_start[r]] up to
+                                   ends[row_start[r + 1]] */
+        int *ends;
+};
+
+/* Header size, rounded up so the offsets that follow stay aligned */
+#define HEADER_BYTES ((sizeof(struct T) + 15) & ~(size_t) 15)
+
+/* Running totals while counting, then filling in, the runs */
+struct encoding {
+        T rle;
+        size_t next;
+        int row;
+};
+
+static void count_run(int row, int start, int length, int bit,
+                      Bit2_T bitmap, void *cl);
+static void store_run(int row, int start, int length, int bit,
+                      Bit2_T bitmap, void *cl);
+
+/******** Bit2rle_encode ********
+ *
+ * Compress a bitmap into runs
+ *
+ * Parameters:
+ *      Bit2_T bitmap:  the bitmap to compress
+ * Return:
+ *      a new Bit2rle holding the same pixels
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer or if malloc fails
+ * Notes:
+ *      Two passes of Bit2_map_runs: the first counts the runs so the single
+ *      block can be sized exactly, the second stores them.
+ ************************/
+T Bit2rle_encode(Bit2_T bitmap)
+{
+        assert(bitmap != NULL);
+
+        int height = Bit2_height(bitmap);
+        struct encoding counter = { NULL, 0, -1 };
+
+        Bit2_map_runs(bitmap, count_run, &counter);
+
+        size_t offsets = ((size_t) height + 1) * sizeof(size_t);
+        assert(counter.next <= (SIZE_MAX - HEADER_BYTES - offsets) /
+                               sizeof(int));
+        size_t bytes = HEADER_BYTES + offsets + counter.next * sizeof(int);
+
+        char *block = malloc(bytes);
+        assert(block != NULL);
+
+        T rle = (T) block;
+        rle->width = Bit2_width(bitmap);
+        rle->height = height;
+        rle->runs = counter.next;
+        rle->bytes = bytes;
+        rle->row_start = (size_t *) (block + HEADER_BYTES);
+        rle->ends = (int *) (block + HEADER_BYTES + offsets);
+
+        struct encoding filler = { rle, 0, -1 };
+        Bit2_map_runs(bitmap, store_run, &filler);
+
+        /* Close off the last row, and any rows that had no runs at all */
+        for (int row = filler.row + 1; row <= height; row++) {
+                rle->row_start[row] = filler.next;
+        }
+
+        return rle;
+}
+
+/******** count_run ********
+ *
+ * Bit2_map_runs callback that counts the run ends Bit2rle_encode will store
+ *
+ * Parameters:
+ *      int row:                row of the run
+ *      int start, length:      unused
+ *      int bit:                value of the run
+ *      Bit2_T bitmap:          unused
+ *      void *cl:               struct encoding being counted into
+ * Return:
+ *      nothing
+ * Expects:
+ *      cl is not NULL
+ * Notes:
+ *      A row whose first run is black needs one extra, empty, white run.
+ ************************/
+static void count_run(int row, int start, int length, int bit,
+                      Bit2_T bitmap, void *cl)
+{
+        struct encoding *counter = cl;
+        (void) start;
+        (void) length;
+        (void) bitmap;
+
+        if (row != counter->row) {
+                counter->row = row;
+                counter->next += bit;
+        }
+        counter->next++;
+}
+
+/******** store_run ********
+ *
+ * Bit2_map_runs callback that records each run's end, and each row's first
+ * run, in the Bit2rle being built
+ *
+ * Parameters:
+ *      int row:                row of the run
+ *      int start, length:      the run's first column and length
+ *      int bit:                value of the run
+ *      Bit2_T bitmap:          unused
+ *      void *cl:               struct encoding being filled in
+ * Return:
+ *      nothing
+ * Expects:
+ *      cl is not NULL
+ ************************/
+static void store_run(int row, int start, int length, int bit,
+                      Bit2_T bitmap, void *cl)
+{
+        struct encoding *filler = cl;
+        T rle = filler->rle;
+        (void) bitmap;
+
+        if (row != filler->row) {
+                /* Rows in between had no runs */
+                for (int r = filler->row + 1; r <= row; r++) {
+                        rle->row_start[r] = filler->next;
+                }
+                filler->row = row;
+                if (bit == 1) {
+                        rle->ends[filler->next++] = 0;
+                }
+        }
+        rle->ends[filler->next++] = start + length;
+}
+
+/******** Bit2rle_decode ********
+ *
+ * Expand runs back into an ordinary bitmap
+ *
+ * Parameters:
+ *      T rle:          the compressed bitmap
+ * Return:
+ *      a new heap-allocated Bit2_T with the same pixels
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer or if allocation fails
+ * Notes:
+ *      The new bitmap starts white, so only black runs are written, each
+ *      with one word-at-a-time Bit2_invert_rect.
+ ************************/
+Bit2_T Bit2rle_decode(T rle)
+{
+        assert(rle != NULL);
+
+        Bit2_T bitmap = Bit2_new(rle->width, rle->height);
+
+        for (int row = 0; row < rle->height; row++) {
+                int start = 0;
+
+                for (size_t k = rle->row_start[row];
+                     k < rle->row_start[row + 1]; k++) {
+                        int end = rle->ends[k];
+
+                        if ((k - rle->row_start[row]) % 2 == 1) {
+                                Bit2_invert_rect(bitmap, start, row,
+                                                 end - start, 1);
+                        }
+                        start = end;
+                }
+        }
+
+        return bitmap;
+}
+
+/******** Bit2rle_free ********
+ *
+ * Deallocates memory used by a compressed bitmap
+ *
+ * Parameters:
+ *      T *rle:         pointer to the Bit2rle_T to free
+ * Return:
+ *      Nothing, *rle is set to NULL
+ * Expects:
+ *      rle and *rle are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Header, offsets and run ends are one block
+ ************************/
+void Bit2rle_free(T *rle)
+{
+        assert(rle != NULL && *rle != NULL);
+
+        free(*rle);
+        *rle = NULL;
+}
+
+/******** Bit2rle_width ********
+ *
+ * Returns the width (number of columns) of the compressed bitmap
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      Number of columns
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+int Bit2rle_width(T rle)
+{
+        assert(rle != NULL);
+
+        return rle->width;
+}
+
+/******** Bit2rle_height ********
+ *
+ * Returns the height (number of rows) of the compressed bitmap
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      Number of rows
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+int Bit2rle_height(T rle)
+{
+        assert(rle != NULL);
+
+        return rle->height;
+}
+
+/******** Bit2rle_runs ********
+ *
+ * Returns the total number of runs stored
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      number of runs over all rows, counting the empty white runs that
+ *      start rows beginning in black
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+size_t Bit2rle_runs(T rle)
+{
+        assert(rle != NULL);
+
+        return rle->runs;
+}
+
+/******** Bit2rle_bytes ********
+ *
+ * Returns the number of bytes the compressed bitmap occupies
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      size of its single allocation, header included
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+size_t Bit2rle_bytes(T rle)
+{
+        assert(rle != NULL);
+
+        return rle->bytes;
+}
+
+/******** Bit2rle_get ********
+ *
+ * Retrieves the bit value at specified coordinates
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ *      int col:        column index (0-based)
+ *      int row:        row index (0-based)
+ * Return:
+ *      0 or 1 (the bit value)
+ * Expects:
+ *      rle is not NULL
+ *      col in range [0, width-1]
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Finds the first run of the row that ends after col; its position in
+ *      the row gives the value.
+ ************************/
+int Bit2rle_get(T rle, int col, int row)
+{
+        assert(rle != NULL && 0 <= col && col < rle->width && 0 <= row &&
+               row < rle->height);
+
+        size_t first = rle->row_start[row];
+        size_t lo = first;
+        size_t hi = rle->row_start[row + 1];
+
+        while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+
+                if (rle->ends[mid] <= col) {
+                        lo = mid + 1;
+                } else {
+                        hi = mid;
+                }
+        }
+
+        return (int) ((lo - first) % 2);
+}
+
+/******** Bit2rle_map_runs ********
+ *
+ * Visit the compressed bitmap as horizontal runs of equal bits, row by row
+ * from left to right
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ *      void apply:     function applied to each run, given its row, first
+ *                      column, length, bit value, the Bit2rle, and the
+ *                      closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      Nothing
+ * Expects:
+ *      rle and apply are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      The empty white runs that start rows beginning in black are skipped.
+ ************************/
+void Bit2rle_map_runs(T rle,
+        void apply(int row, int start, int length, int bit, T rle, void *cl),
+        void *cl)
+{
+        assert(rle != NULL && apply != NULL);
+
+        for (int row = 0; row < rle->height; row++) {
+                int start = 0;
+                size_t first = rle->row_start[row];
+
+                for (size_t k = first; k < rle->row_start[row + 1]; k++) {
+                        int end = rle->ends[k];
+
+                        if (end > start) {
+                                apply(row, start, end - start,
+                                      (int) ((k - first) % 2), rle, cl);
+                        }
+                        start = end;
+                }
+        }
+}
+
+#undef T
@@ -0,0 +1,171 @@
+/*
+ *      bit2rle.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Interface for run-length-compressed two-dimensional bit arrays. A
+ *      Bit2rle holds the same pixels as a Bit2, but stores each row as the
+ *      columns where its runs end, so a mostly-uniform page costs a few
+ *      bytes per row instead of one bit per pixel. A Bit2rle is read-only:
+ *      make one from a Bit2, and decode it back to edit it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "bit2.h"
+
+#ifndef BIT2RLE_INCLUDED
+#define BIT2RLE_INCLUDED
+
+#define T Bit2rle_T
+
+typedef struct T *T;
+
+/******** Bit2rle_encode ********
+ *
+ * Compress a bitmap into runs
+ *
+ * Parameters:
+ *      Bit2_T bitmap:  the bitmap to compress
+ * Return:
+ *      a new Bit2rle holding the same pixels
+ * Expects:
+ *      bitmap is not NULL
+ *      Throws CRE if NULL pointer or if malloc fails
+ * Notes:
+ *      The bitmap is left alone and may be freed afterwards.
+ ************************/
+T Bit2rle_encode(Bit2_T bitmap);
+
+/******** Bit2rle_decode ********
+ *
+ * Expand runs back into an ordinary bitmap
+ *
+ * Parameters:
+ *      T rle:          the compressed bitmap
+ * Return:
+ *      a new heap-allocated Bit2_T with the same pixels
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer or if allocation fails
+ ************************/
+Bit2_T Bit2rle_decode(T rle);
+
+/******** Bit2rle_free ********
+ *
+ * Deallocates memory used by a compressed bitmap
+ *
+ * Parameters:
+ *      T *rle:         pointer to the Bit2rle_T to free
+ * Return:
+ *      Nothing, *rle is set to NULL
+ * Expects:
+ *      rle and *rle are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+void Bit2rle_free(T *rle);
+
+/******** Bit2rle_width ********
+ *
+ * Returns the width (number of columns) of the compressed bitmap
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      Number of columns
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+int Bit2rle_width(T rle);
+
+/******** Bit2rle_height ********
+ *
+ * Returns the height (number of rows) of the compressed bitmap
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      Number of rows
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+int Bit2rle_height(T rle);
+
+/******** Bit2rle_runs ********
+ *
+ * Returns the total number of runs stored
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      number of runs over all rows, counting the empty white runs that
+ *      start rows beginning in black
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+size_t Bit2rle_runs(T rle);
+
+/******** Bit2rle_bytes ********
+ *
+ * Returns the number of bytes the compressed bitmap occupies
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ * Return:
+ *      size of its single allocation, header included
+ * Expects:
+ *      rle is not NULL
+ *      Throws CRE if NULL pointer
+ * Notes:
+ *      Compare with (width + 63) / 64 * 8 * height for a Bit2.
+ ************************/
+size_t Bit2rle_bytes(T rle);
+
+/******** Bit2rle_get ********
+ *
+ * Retrieves the bit value at specified coordinates
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ *      int col:        column index (0-based)
+ *      int row:        row index (0-based)
+ * Return:
+ *      0 or 1 (the bit value)
+ * Expects:
+ *      rle is not NULL
+ *      col in range [0, width-1]
+ *      row in range [0, height-1]
+ *      Throws CRE if out of bounds or NULL pointer
+ * Notes:
+ *      Binary search over the row's runs, so O(log runs in the row)
+ ************************/
+int Bit2rle_get(T rle, int col, int row);
+
+/******** Bit2rle_map_runs ********
+ *
+ * Visit the compressed bitmap as horizontal runs of equal bits, row by row
+ * from left to right, exactly as Bit2_map_runs visits the original
+ *
+ * Parameters:
+ *      T rle:          Bit2rle_T instance
+ *      void apply:     function applied to each run, given its row, first
+ *                      column, length, bit value, the Bit2rle, and the
+ *                      closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      Nothing
+ * Expects:
+ *      rle and apply are not NULL
+ *      Throws CRE if NULL pointers
+ ************************/
+void Bit2rle_map_runs(T rle,
+        void apply(int row, int start, int length, int bit, T rle, void *cl),
+        void *cl);
+
+#undef T
+#endif
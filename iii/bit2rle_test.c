@@ -0,0 +1,273 @@
+/*
+ *      bit2rle_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Test for run-length-compressed bitmaps. Each image is encoded, then
+ *      checked three ways against the original: decoding it back, reading
+ *      every pixel with Bit2rle_get, and rebuilding it from the runs that
+ *      Bit2rle_map_runs hands over. Images include empty, uniform, noisy,
+ *      and sparse ones, with widths on and around word boundaries.
+ *
+ *      Usage: bit2rle_test
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#include <stdint.h>
+#include "bit2.h"
+#include "bit2rle.h"
+#include "assert.h"
+
+/* How an image is filled in */
+typedef enum { WHITE, BLACK, NOISE, SPARSE } Pattern;
+
+/* A bitmap being rebuilt from runs, and how many runs built it */
+typedef struct Rebuild {
+        Bit2_T bitmap;
+        size_t runs;
+} Rebuild;
+
+bool check_image(Bit2_T image);
+Bit2_T make_image(int width, int height, Pattern pattern, uint64_t *state);
+uint64_t next_random(uint64_t *state);
+void fill_run(int row, int start, int length, int bit, Bit2rle_T rle,
+              void *cl);
+void count_run(int row, int start, int length, int bit, Bit2_T bitmap,
+               void *cl);
+
+/******** main ********
+ *
+ * Round-trip every size and pattern through Bit2rle and report failures
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every image survived, EXIT_FAILURE otherwise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      none
+ ************************/
+int main(void)
+{
+        static const int sizes[][2] = {
+                { 0, 0 },  { 0, 5 },  { 5, 0 },   { 1, 1 },  { 1, 9 },
+                { 63, 4 }, { 64, 4 }, { 65, 4 },  { 130, 7 }, { 200, 30 }
+        };
+        static const char *names[] = { "white", "black", "noise", "sparse" };
+        int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+        uint64_t state = 0x9e3779b97f4a7c15u;
+        int failures = 0;
+
+        for (int i = 0; i < nsizes; i++) {
+                for (Pattern p = WHITE; p <= SPARSE; p++) {
+                        Bit2_T image = make_image(sizes[i][0], sizes[i][1],
+                                                  p, &state);
+
+                        if (!check_image(image)) {
+                                printf("FAIL: %d x %d %s image\n",
+                                       sizes[i][0], sizes[i][1], names[p]);
+                                failures++;
+                        }
+                        Bit2_free(&image);
+                }
+        }
+
+        printf("bit2rle_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_image ********
+ *
+ * Encode an image and check the result against it
+ *
+ * Parameters:
+ *      Bit2_T image:   the image, left alone
+ * Return:
+ *      true if the size and run counts match, the decoded bitmap and every
+ *      Bit2rle_get equal the image, and the runs rebuild it exactly
+ * Expects:
+ *      image is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Matching Bit2_map_runs's run count, while covering every pixel,
+ *      means the stored runs are maximal.
+ ************************/
+bool check_image(Bit2_T image)
+{
+        int width = Bit2_width(image);
+        int height = Bit2_height(image);
+        Bit2rle_T rle = Bit2rle_encode(image);
+        Bit2_T decoded = Bit2rle_decode(rle);
+        Rebuild rebuild = { Bit2_new(width, height), 0 };
+        size_t runs = 0;
+        size_t stored = 0;
+
+        Bit2_map_runs(image, count_run, &runs);
+        /* A row starting in black also stores an empty white run first */
+        for (int row = 0; row < height && width > 0; row++) {
+                stored += Bit2_get(image, 0, row);
+        }
+        stored += runs;
+        Bit2rle_map_runs(rle, fill_run, &rebuild);
+
+        Bit2_T decode_diff = Bit2_diff(decoded, image);
+        Bit2_T rebuild_diff = Bit2_diff(rebuild.bitmap, image);
+        bool ok = Bit2rle_width(rle) == width &&
+                  Bit2rle_height(rle) == height &&
+                  Bit2rle_runs(rle) == stored && rebuild.runs == runs &&
+                  Bit2_count(decode_diff) == 0 &&
+                  Bit2_count(rebuild_diff) == 0;
+
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width && ok; col++) {
+                        ok = Bit2rle_get(rle, col, row) ==
+                             Bit2_get(image, col, row);
+                }
+        }
+
+        Bit2_free(&decode_diff);
+        Bit2_free(&rebuild_diff);
+        Bit2_free(&rebuild.bitmap);
+        Bit2_free(&decoded);
+        Bit2rle_free(&rle);
+
+        return ok && rle == NULL;
+}
+
+/******** make_image ********
+ *
+ * Build a test image
+ *
+ * Parameters:
+ *      int width, height:      size of the image
+ *      Pattern pattern:        how to fill it
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      a new bitmap: all 0, all 1, half-density noise, or a few random
+ *      rectangles of 1s on 0
+ * Expects:
+ *      width and height are nonnegative
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      Noise is laid down a word at a time; Bit2_put_word keeps the row
+ *      padding zero.
+ ************************/
+Bit2_T make_image(int width, int height, Pattern pattern, uint64_t *state)
+{
+        Bit2_T image = Bit2_new(width, height);
+        int words = Bit2_words_per_row(image);
+
+        if (width == 0 || height == 0 || pattern == WHITE) {
+                return image;
+        }
+        if (pattern == BLACK) {
+                Bit2_fill_rect(image, 0, 0, width, height, 1);
+                return image;
+        }
+        if (pattern == NOISE) {
+                for (int row = 0; row < height; row++) {
+                        for (int word = 0; word < words; word++) {
+                                Bit2_put_word(image, word, row,
+                                              next_random(state));
+                        }
+                }
+                return image;
+        }
+
+        for (int i = 0; i < 5; i++) {
+                int col = (int) (next_random(state) % (uint64_t) width);
+                int row = (int) (next_random(state) % (uint64_t) height);
+                int w = 1 + (int) (next_random(state) %
+                                   (uint64_t) (width - col));
+                int h = 1 + (int) (next_random(state) %
+                                   (uint64_t) (height - row));
+
+                Bit2_fill_rect(image, col, row, w, h, 1);
+        }
+
+        return image;
+}
+
+/******** next_random ********
+ *
+ * Step a xorshift64 generator
+ *
+ * Parameters:
+ *      uint64_t *state:        generator state, never 0
+ * Return:
+ *      the next 64 random bits
+ * Expects:
+ *      state is not NULL
+ * Notes:
+ *      none
+ ************************/
+uint64_t next_random(uint64_t *state)
+{
+        uint64_t x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+
+        return x;
+}
+
+/******** fill_run ********
+ *
+ * Bit2rle_map_runs apply function: copy one run into the rebuilt bitmap
+ *
+ * Parameters:
+ *      int row, start, length: where the run is
+ *      int bit:                its value
+ *      Bit2rle_T rle:          the compressed bitmap, unused
+ *      void *cl:               the Rebuild
+ * Return:
+ *      nothing
+ * Expects:
+ *      cl is not NULL and the run lies inside the bitmap. Throws CRE
+ *      otherwise.
+ * Notes:
+ *      The rebuilt bitmap starts all 0, so 0 runs are only counted.
+ ************************/
+void fill_run(int row, int start, int length, int bit, Bit2rle_T rle,
+              void *cl)
+{
+        Rebuild *rebuild = cl;
+        (void) rle;
+
+        if (bit == 1) {
+                Bit2_fill_rect(rebuild->bitmap, start, row, length, 1, 1);
+        }
+        rebuild->runs++;
+}
+
+/******** count_run ********
+ *
+ * Bit2_map_runs apply function: count one run of the original
+ *
+ * Parameters:
+ *      int row, start, length: where the run is, unused
+ *      int bit:                its value, unused
+ *      Bit2_T bitmap:          the original bitmap, unused
+ *      void *cl:               pointer to the size_t count
+ * Return:
+ *      nothing
+ * Expects:
+ *      cl is not NULL
+ * Notes:
+ *      none
+ ************************/
+void count_run(int row, int start, int length, int bit, Bit2_T bitmap,
+               void *cl)
+{
+        (void) row;
+        (void) start;
+        (void) length;
+        (void) bit;
+        (void) bitmap;
+
+        (*(size_t *) cl)++;
+}
@@ -0,0 +1,127 @@
+/*
+ *      mapfile.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of memory-mapped grid files
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapfile.h"
+#include "assert.h"
+
+/******** Mapfile_create ********
+ *
+ * Create (or truncate) a grid file big enough for header plus payload bytes,
+ * write the header, and map the whole file shared and read-write
+ *
+ * Parameters:
+ *      const char *path:       file to create
+ *      Mapfile_header header:  header to write at offset 0
+ *      size_t payload:         number of payload bytes after the header
+ * Return:
+ *      pointer to the start of the mapping
+ * Expects:
+ *      path is not NULL
+ *      Throws CRE if the file cannot be created, sized, or mapped
+ * Notes:
+ *      ftruncate zero-fills the new file, so the payload starts out zeroed
+ *      without touching every page.
+ ************************/
+void *Mapfile_create(const char *path, Mapfile_header header, size_t payload)
+{
+        assert(path != NULL);
+        assert(sizeof(Mapfile_header) == MAPFILE_HEADER_BYTES);
+
+        size_t bytes = MAPFILE_HEADER_BYTES + payload;
+
+        int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        int sized = ftruncate(fd, (off_t) bytes);
+        assert(sized == 0);
+
+        void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                         0);
+        close(fd);
+        assert(map != MAP_FAILED);
+
+        memcpy(map, &header, sizeof(header));
+
+        return map;
+}
+
+/******** Mapfile_open ********
+ *
+ * Map an existing grid file and check its header
+ *
+ * Parameters:
+ *      const char *path:       file to open
+ *      const char *magic:      expected magic (at most 8 characters)
+ *      uint32_t version:       expected payload layout version
+ *      bool writable:          whether writes should reach the file
+ *      Mapfile_header *header: filled in with the file's header
+ *      size_t *bytes:          filled in with the length of the mapping
+ * Return:
+ *      pointer to the start of the mapping
+ * Expects:
+ *      all pointers are not NULL
+ *      Throws CRE if the file cannot be opened or mapped, or if its magic or
+ *      version do not match
+ * Notes:
+ *      A private mapping may be written even though the file was opened
+ *      O_RDONLY; the kernel copies each page on its first write.
+ ************************/
+void *Mapfile_open(const char *path, const char *magic, uint32_t version,
+                   bool writable, Mapfile_header *header, size_t *bytes)
+{
+        assert(path != NULL && magic != NULL && header != NULL &&
+               bytes != NULL);
+
+        int fd = open(path, writable ? O_RDWR : O_RDONLY);
+        assert(fd >= 0);
+
+        struct stat info;
+        int found = fstat(fd, &info);
+        assert(found == 0);
+        assert(info.st_size >= MAPFILE_HEADER_BYTES);
+        *bytes = (size_t) info.st_size;
+
+        void *map = mmap(NULL, *bytes, PROT_READ | PROT_WRITE,
+                         writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        close(fd);
+        assert(map != MAP_FAILED);
+
+        memcpy(header, map, sizeof(*header));
+        assert(strncmp(header->magic, magic, sizeof(header->magic)) == 0);
+        assert(header->version == version);
+
+        return map;
+}
+
+/******** Mapfile_close ********
+ *
+ * Unmap a grid file mapped by Mapfile_create or Mapfile_open
+ *
+ * Parameters:
+ *      void *map:      start of the mapping
+ *      size_t bytes:   length of the mapping
+ * Return:
+ *      Nothing
+ * Expects:
+ *      map is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void Mapfile_close(void *map, size_t bytes)
+{
+        assert(map != NULL);
+
+        munmap(map, bytes);
+}
@@ -0,0 +1,105 @@
+/*
+ *      mapfile.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Interface for memory-mapped grid files. UArray2 and Bit2 use this to
+ *      keep their cells in a file instead of on the heap.
+ *
+ *      On-disk layout (all fields in host byte order):
+ *
+ *          offset  size  field
+ *               0     8  magic, identifies the grid type (NUL padded)
+ *               8     4  version of the payload layout for that type
+ *              12     4  bytes per cell (0 for bitmaps)
+ *              16     8  width
+ *              24     8  height
+ *              32    32  reserved, zero
+ *              64     -  payload, layout defined by the grid type
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifndef MAPFILE_INCLUDED
+#define MAPFILE_INCLUDED
+
+/* Bytes before the payload of a grid file */
+#define MAPFILE_HEADER_BYTES 64
+
+typedef struct Mapfile_header {
+        char magic[8];
+        uint32_t version;
+        uint32_t size;
+        uint64_t width;
+        uint64_t height;
+        uint64_t reserved[4];
+} Mapfile_header;
+
+/******** Mapfile_create ********
+ *
+ * Create (or truncate) a grid file big enough for header plus payload bytes,
+ * write the header, and map the whole file shared and read-write
+ *
+ * Parameters:
+ *      const char *path:       file to create
+ *      Mapfile_header header:  header to write at offset 0
+ *      size_t payload:         number of payload bytes after the header
+ * Return:
+ *      pointer to the start of the mapping; the payload starts
+ *      MAPFILE_HEADER_BYTES after it and is zero-filled
+ * Expects:
+ *      path is not NULL
+ *      Throws CRE if the file cannot be created, sized, or mapped
+ * Notes:
+ *      The mapping is MAP_SHARED, so writes reach the file and are seen by
+ *      every process mapping it.
+ ************************/
+void *Mapfile_create(const char *path, Mapfile_header header, size_t payload);
+
+/******** Mapfile_open ********
+ *
+ * Map an existing grid file and check its header
+ *
+ * Parameters:
+ *      const char *path:       file to open
+ *      const char *magic:      expected magic (at most 8 characters)
+ *      uint32_t version:       expected payload layout version
+ *      bool writable:          whether writes should reach the file
+ *      Mapfile_header *header: filled in with the file's header
+ *      size_t *bytes:          filled in with the length of the mapping
+ * Return:
+ *      pointer to the start of the mapping
+ * Expects:
+ *      all pointers are not NULL
+ *      Throws CRE if the file cannot be opened or mapped, or if its magic or
+ *      version do not match
+ * Notes:
+ *      A writable file is opened read-write and mapped shared. Otherwise
+ *      the file is only opened for reading, so a read-only file can be
+ *      mapped too, and the mapping is private: the caller may still write
+ *      to it, but those writes go to copied pages and never to the file.
+ *      The caller checks that *bytes matches the dimensions in *header.
+ ************************/
+void *Mapfile_open(const char *path, const char *magic, uint32_t version,
+                   bool writable, Mapfile_header *header, size_t *bytes);
+
+/******** Mapfile_close ********
+ *
+ * Unmap a grid file mapped by Mapfile_create or Mapfile_open
+ *
+ * Parameters:
+ *      void *map:      start of the mapping
+ *      size_t bytes:   length of the mapping
+ * Return:
+ *      Nothing
+ * Expects:
+ *      map is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Dirty pages are written back to the file by the kernel.
+ ************************/
+void Mapfile_close(void *map, size_t bytes);
+
+#endif
@@ -0,0 +1,357 @@
+/*
+ *      mapfile_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Test for memory-mapped grid files. A grid is made in a file, filled,
+ *      and freed; it is then opened again, writable and read-only, and
+ *      checked pixel by pixel (or cell by cell) against what was put in. A
+ *      change made through a writable open must reach the file, and one
+ *      made through a read-only open must not. Bit2 widths sit on and
+ *      around word boundaries, and mapped bitmaps must keep their padding
+ *      bits 0 like heap ones.
+ *
+ *      Usage: mapfile_test
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bit2.h"
+#include "uarray2.h"
+#include "mapfile.h"
+#include "assert.h"
+
+/* Payload bytes in the raw grid file */
+#define PAYLOAD 100
+
+bool check_mapfile(const char *path);
+bool check_bit2(const char *path, int width, int height, uint64_t *state);
+bool bit2_matches(Bit2_T bitmap, const unsigned char *pixels);
+bool check_uarray2(const char *path, int width, int height);
+bool uarray2_matches(UArray2_T array, bool negated);
+uint64_t next_random(uint64_t *state);
+
+/******** main ********
+ *
+ * Run every check on every size and report the failures
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every check passed, EXIT_FAILURE otherwise
+ * Expects:
+ *      Throws CRE if the temporary file cannot be made or mapped
+ * Notes:
+ *      The grid files share one temporary path, removed at the end.
+ ************************/
+int main(void)
+{
+        static const int sizes[][2] = {
+                { 0, 4 },  { 1, 1 },  { 1, 6 },   { 63, 5 },
+                { 64, 5 }, { 65, 5 }, { 130, 3 }, { 200, 9 }
+        };
+        int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+        uint64_t state = 0x9e3779b97f4a7c15u;
+        char path[] = "/tmp/mapfile_testXXXXXX";
+        int fd = mkstemp(path);
+        int failures = 0;
+
+        assert(fd >= 0);
+        close(fd);
+
+        if (!check_mapfile(path)) {
+                printf("FAIL: raw grid file\n");
+                failures++;
+        }
+        for (int i = 0; i < nsizes; i++) {
+                int width = sizes[i][0];
+                int height = sizes[i][1];
+
+                if (!check_bit2(path, width, height, &state)) {
+                        printf("FAIL: %d x %d mapped Bit2\n", width, height);
+                        failures++;
+                }
+                if (!check_uarray2(path, width, height)) {
+                        printf("FAIL: %d x %d mapped UArray2\n", width,
+                               height);
+                        failures++;
+                }
+        }
+        remove(path);
+
+        printf("mapfile_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_mapfile ********
+ *
+ * Check a grid file's header and payload through Mapfile directly
+ *
+ * Parameters:
+ *      const char *path:       file to use, overwritten
+ * Return:
+ *      true if the header and payload read back as written, the mapping is
+ *      the right length, and a write through a read-only open is not kept
+ * Expects:
+ *      path is not NULL. Throws CRE otherwise, or if the file cannot be
+ *      made or mapped.
+ * Notes:
+ *      The read-only opens are done with the file's write permission
+ *      removed.
+ ************************/
+bool check_mapfile(const char *path)
+{
+        Mapfile_header header = { "TEST", 3, 4, 25, 1, { 0, 0, 0, 0 } };
+        Mapfile_header found;
+        size_t bytes;
+        unsigned char *map = Mapfile_create(path, header, PAYLOAD);
+        bool ok = true;
+
+        for (int i = 0; i < PAYLOAD; i++) {
+                ok = ok && map[MAPFILE_HEADER_BYTES + i] == 0;
+                map[MAPFILE_HEADER_BYTES + i] = (unsigned char) i;
+        }
+        Mapfile_close(map, MAPFILE_HEADER_BYTES + PAYLOAD);
+
+        chmod(path, S_IRUSR);
+        for (int pass = 0; pass < 2; pass++) {
+                map = Mapfile_open(path, "TEST", 3, false, &found, &bytes);
+                ok = ok && memcmp(&found, &header, sizeof(header)) == 0 &&
+                     bytes == MAPFILE_HEADER_BYTES + PAYLOAD;
+                for (int i = 0; i < PAYLOAD; i++) {
+                        ok = ok && map[MAPFILE_HEADER_BYTES + i] == i;
+                        map[MAPFILE_HEADER_BYTES + i] = 0;
+                }
+                Mapfile_close(map, bytes);
+        }
+        chmod(path, S_IRUSR | S_IWUSR);
+
+        return ok;
+}
+
+/******** check_bit2 ********
+ *
+ * Check a mapped Bit2 through a create, a writable open, and read-only
+ * opens
+ *
+ * Parameters:
+ *      const char *path:       file to use, overwritten
+ *      int width, height:      size of the bitmap
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      true if every open holds the expected pixels with clear padding
+ * Expects:
+ *      path is not NULL and width and height are nonnegative
+ *      Throws CRE otherwise, or if the file cannot be made or mapped
+ * Notes:
+ *      Half the rows are filled a pixel at a time and half a word at a
+ *      time, with random bits past the width that must be dropped. Each
+ *      open inverts every pixel; only the writable open's inversion should
+ *      be in the file afterwards.
+ ************************/
+bool check_bit2(const char *path, int width, int height, uint64_t *state)
+{
+        size_t npixels = (size_t) width * height;
+        unsigned char *pixels = calloc(npixels + 1, 1);
+        Bit2_T bitmap = Bit2_new_mapped(path, width, height);
+        int words = Bit2_words_per_row(bitmap);
+
+        assert(pixels != NULL);
+
+        bool ok = bit2_matches(bitmap, pixels);
+
+        for (int row = 0; row < height; row++) {
+                for (int word = 0; word < words && row % 2 == 0; word++) {
+                        uint64_t bits = next_random(state);
+
+                        Bit2_put_word(bitmap, word, row, bits);
+                        for (int i = 0; i < 64 && 64 * word + i < width;
+                             i++) {
+                                pixels[row * width + 64 * word + i] =
+                                        (bits >> i) & 1;
+                        }
+                }
+                for (int col = 0; col < width && row % 2 == 1; col++) {
+                        pixels[row * width + col] = next_random(state) & 1;
+                        Bit2_put(bitmap, col, row, pixels[row * width + col]);
+                }
+        }
+        Bit2_free(&bitmap);
+
+        for (int pass = 0; pass < 3; pass++) {
+                if (pass == 1) {
+                        chmod(path, S_IRUSR);
+                }
+                bitmap = Bit2_open_mapped(path, pass == 0);
+                ok = ok && bit2_matches(bitmap, pixels);
+
+                Bit2_invert(bitmap);
+                for (size_t p = 0; p < npixels && pass == 0; p++) {
+                        pixels[p] = !pixels[p];
+                }
+                Bit2_free(&bitmap);
+        }
+        chmod(path, S_IRUSR | S_IWUSR);
+
+        free(pixels);
+
+        return ok;
+}
+
+/******** bit2_matches ********
+ *
+ * Whether a bitmap holds exactly the given pixels
+ *
+ * Parameters:
+ *      Bit2_T bitmap:                  the bitmap
+ *      const unsigned char *pixels:    one byte per pixel, row-major
+ * Return:
+ *      true if every Bit2_get matches its pixel and no padding bit is set
+ * Expects:
+ *      bitmap and pixels are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool bit2_matches(Bit2_T bitmap, const unsigned char *pixels)
+{
+        int width = Bit2_width(bitmap);
+        int last = Bit2_words_per_row(bitmap) - 1;
+        bool ok = true;
+
+        assert(pixels != NULL);
+        for (int row = 0; row < Bit2_height(bitmap) && ok; row++) {
+                for (int col = 0; col < width && ok; col++) {
+                        ok = Bit2_get(bitmap, col, row) ==
+                             pixels[row * width + col];
+                }
+                if (width % 64 != 0) {
+                        ok = ok && Bit2_get_word(bitmap, last, row) >>
+                                   (width % 64) == 0;
+                }
+        }
+
+        return ok;
+}
+
+/******** check_uarray2 ********
+ *
+ * Check a mapped UArray2 through a create, a writable open, and read-only
+ * opens
+ *
+ * Parameters:
+ *      const char *path:       file to use, overwritten
+ *      int width, height:      size of the array
+ * Return:
+ *      true if every open reports the size it was made with and holds the
+ *      expected cells
+ * Expects:
+ *      path is not NULL and width and height are nonnegative
+ *      Throws CRE otherwise, or if the file cannot be made or mapped
+ * Notes:
+ *      Each cell holds its row-major index. Each open then negates every
+ *      cell; only the writable open's change should be in the file
+ *      afterwards.
+ ************************/
+bool check_uarray2(const char *path, int width, int height)
+{
+        UArray2_T array = UArray2_new_mapped(path, width, height,
+                                             sizeof(long));
+        bool ok = true;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        long *cell = UArray2_at(array, col, row);
+
+                        ok = ok && *cell == 0;
+                        *cell = (long) row * width + col;
+                }
+        }
+        UArray2_free(&array);
+
+        for (int pass = 0; pass < 3; pass++) {
+                if (pass == 1) {
+                        chmod(path, S_IRUSR);
+                }
+                array = UArray2_open_mapped(path, pass == 0);
+                ok = ok && UArray2_width(array) == width &&
+                     UArray2_height(array) == height &&
+                     UArray2_size(array) == sizeof(long) &&
+                     uarray2_matches(array, pass > 0);
+
+                for (int row = 0; row < height; row++) {
+                        for (int col = 0; col < width; col++) {
+                                long *cell = UArray2_at(array, col, row);
+
+                                *cell = -*cell - 1;
+                        }
+                }
+                UArray2_free(&array);
+        }
+        chmod(path, S_IRUSR | S_IWUSR);
+
+        return ok;
+}
+
+/******** uarray2_matches ********
+ *
+ * Whether every cell of an array holds its row-major index
+ *
+ * Parameters:
+ *      UArray2_T array:        the array of longs
+ *      bool negated:           whether the cells should hold -index - 1
+ *                              instead
+ * Return:
+ *      true if every cell holds what it should
+ * Expects:
+ *      array is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool uarray2_matches(UArray2_T array, bool negated)
+{
+        int width = UArray2_width(array);
+        bool ok = true;
+
+        for (int row = 0; row < UArray2_height(array) && ok; row++) {
+                for (int col = 0; col < width && ok; col++) {
+                        long index = (long) row * width + col;
+                        long *cell = UArray2_at(array, col, row);
+
+                        ok = *cell == (negated ? -index - 1 : index);
+                }
+        }
+
+        return ok;
+}
+
+/******** next_random ********
+ *
+ * Step a xorshift64 generator
+ *
+ * Parameters:
+ *      uint64_t *state:        generator state, never 0
+ * Return:
+ *      the next 64 random bits
+ * Expects:
+ *      state is not NULL
+ * Notes:
+ *      none
+ ************************/
+uint64_t next_random(uint64_t *state)
+{
+        uint64_t x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+
+        return x;
+}
@@ -0,0 +1,734 @@
+/*
+ *      pbmread.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of the packed PBM reader. Plain (P1) pixels are
+ *      scanned eight bytes at a time with SWAR tests (SIMD within a
+ *      64-bit register): one load says which bytes are '0'/'1' digits,
+ *      which are whitespace, and which digits are '1'. A chunk of nothing
+ *      but digits and whitespace becomes up to eight pixels at once; any
+ *      other chunk (a comment, a stray byte, the end of the input) falls
+ *      back to one byte at a time. Raw (P4) rows are already bits, and only
+ *      need each byte's bit order reversed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "pbmread.h"
+#include "assert.h"
+
+/* Bytes per read when the input cannot be mapped */
+#define BLOCK_BYTES 65536
+
+/* SWAR masks: the low bit, the high bit, or the low 7 bits of every byte */
+#define LOW_BITS  0x0101010101010101u
+#define HIGH_BITS 0x8080808080808080u
+#define LOW_SEVEN 0x7f7f7f7f7f7f7f7fu
+
+/* Where the input bytes come from: one mapping, or a block at a time */
+typedef struct source {
+        FILE *fp;
+        const unsigned char *data;
+        size_t pos;
+        size_t length;
+        unsigned char *block;
+        void *map;
+        size_t map_bytes;
+} Source;
+
+/* Where the pixels go: the row being packed, and the next pixel's place */
+typedef struct sink {
+        Bit2_T bitmap;
+        uint64_t *words;
+        int words_per_row;
+        int width;
+        int height;
+        int col;
+        int row;
+} Sink;
+
+#define T Pbmread_T
+
+struct T {
+        Source src;
+        Sink sink;
+        int type;
+};
+
+static void open_source(Source *src, FILE *fp);
+static void close_source(Source *src);
+static bool refill(Source *src);
+static int next_byte(Source *src);
+static void read_bytes(Source *src, unsigned char *bytes, size_t count);
+static void skip_comment(Source *src);
+static int header_int(Source *src);
+static bool is_space(int c);
+static void read_plain(Source *src, Sink *sink, int limit);
+static bool plain_chunk(Sink *sink, uint64_t chunk);
+static uint64_t zero_bytes(uint64_t x);
+static unsigned gather_high_bits(uint64_t x);
+static void append_bits(Sink *sink, uint64_t bits, int count);
+static void read_raw(Source *src, Sink *sink, int limit);
+static uint64_t load_le(const unsigned char *bytes);
+static uint64_t reverse_byte_bits(uint64_t x);
+
+/******** Pbmread_read ********
+ *
+ * Read a plain (P1) or raw (P4) PBM into a new bitmap
+ *
+ * Parameters:
+ *      FILE *fp:       open stream positioned at the start of the image
+ * Return:
+ *      a new heap-allocated Bit2_T holding the image, black pixels as 1
+ * Expects:
+ *      fp is not NULL and the image is a well-formed PBM
+ *      Throws CRE otherwise, if the image ends early, or if allocation
+ *      fails
+ * Notes:
+ *      One Pbmread_more call for every row
+ ************************/
+Bit2_T Pbmread_read(FILE *fp)
+{
+        assert(fp != NULL);
+
+        T reader = Pbmread_new(fp);
+        Bit2_T bitmap = reader->sink.bitmap;
+
+        Pbmread_more(reader, reader->sink.height);
+        Pbmread_free(&reader);
+
+        return bitmap;
+}
+
+/******** Pbmread_new ********
+ *
+ * Start reading a plain (P1) or raw (P4) PBM a batch of rows at a time
+ *
+ * Parameters:
+ *      FILE *fp:       open stream positioned at the start of the image
+ * Return:
+ *      a new reader, with the header read and an all-white bitmap of the
+ *      image's size ready to be filled in
+ * Expects:
+ *      fp is not NULL and the header is well-formed
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      Rows are packed into a words_per_row buffer (plus one spare word)
+ *      and stored whole with Bit2_put_row.
+ ************************/
+T Pbmread_new(FILE *fp)
+{
+        assert(fp != NULL);
+
+        T reader = malloc(sizeof(*reader));
+        assert(reader != NULL);
+        open_source(&reader->src, fp);
+
+        int magic = next_byte(&reader->src);
+        reader->type = next_byte(&reader->src);
+        assert(magic == 'P' && (reader->type == '1' || reader->type == '4'));
+
+        int width = header_int(&reader->src);
+        int height = header_int(&reader->src);
+        Bit2_T bitmap = Bit2_new(width, height);
+
+        Sink sink = { bitmap, NULL, Bit2_words_per_row(bitmap), width,
+                      height, 0, 0 };
+        sink.words = calloc(sink.words_per_row + 1, sizeof(uint64_t));
+        assert(sink.words != NULL);
+        reader->sink = sink;
+
+        return reader;
+}
+
+/******** Pbmread_free ********
+ *
+ * Deallocates a reader, but not its bitmap
+ *
+ * Parameters:
+ *      T *reader:      pointer to the Pbmread_T to free
+ * Return:
+ *      Nothing, *reader is set to NULL
+ * Expects:
+ *      reader and *reader are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      Unmaps or frees the input buffer; fp is left open
+ ************************/
+void Pbmread_free(T *reader)
+{
+        assert(reader != NULL && *reader != NULL);
+
+        free((*reader)->sink.words);
+        close_source(&(*reader)->src);
+        free(*reader);
+        *reader = NULL;
+}
+
+/******** Pbmread_bitmap ********
+ *
+ * Returns the bitmap a reader fills in
+ *
+ * Parameters:
+ *      T reader:       Pbmread_T instance
+ * Return:
+ *      the bitmap; rows below the count from Pbmread_more are complete
+ * Expects:
+ *      reader is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+Bit2_T Pbmread_bitmap(T reader)
+{
+        assert(reader != NULL);
+
+        return reader->sink.bitmap;
+}
+
+/******** Pbmread_more ********
+ *
+ * Read at least the next rows rows of the image, or up to its end
+ *
+ * Parameters:
+ *      T reader:       Pbmread_T instance
+ *      int rows:       how many more rows to finish
+ * Return:
+ *      the number of rows of the bitmap now complete, from the top
+ * Expects:
+ *      reader is not NULL, rows >= 0
+ *      Throws CRE otherwise, or if the image is malformed or ends early
+ * Notes:
+ *      An image with no columns has nothing to read, so its rows are all
+ *      complete at once.
+ ************************/
+int Pbmread_more(T reader, int rows)
+{
+        assert(reader != NULL && rows >= 0);
+
+        Sink *sink = &reader->sink;
+        int limit = sink->height - sink->row < rows ? sink->height :
+                                                      sink->row + rows;
+
+        if (sink->width == 0) {
+                sink->row = limit;
+        } else if (reader->type == '1') {
+                read_plain(&reader->src, sink, limit);
+        } else {
+                read_raw(&reader->src, sink, limit);
+        }
+
+        return sink->row;
+}
+
+/******** open_source ********
+ *
+ * Set up reading from a stream, mapping it if it is a regular file
+ *
+ * Parameters:
+ *      Source *src:    the source to set up
+ *      FILE *fp:       the stream
+ * Return:
+ *      nothing
+ * Expects:
+ *      Throws CRE if malloc fails
+ * Notes:
+ *      The mapping covers the whole file, and reading starts at the stream's
+ *      current offset. If the file cannot be mapped, it is read in blocks
+ *      like a pipe.
+ ************************/
+static void open_source(Source *src, FILE *fp)
+{
+        struct stat info;
+        int fd = fileno(fp);
+
+        src->fp = fp;
+        src->data = NULL;
+        src->pos = 0;
+        src->length = 0;
+        src->block = NULL;
+        src->map = NULL;
+        src->map_bytes = 0;
+
+        if (fd >= 0 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) &&
+            info.st_size > 0) {
+                off_t offset = ftello(fp);
+                void *map = mmap(NULL, (size_t) info.st_size, PROT_READ,
+                                 MAP_PRIVATE, fd, 0);
+
+                if (map != MAP_FAILED && offset >= 0 &&
+                    offset <= info.st_size) {
+                        posix_madvise(map, (size_t) info.st_size,
+                                      POSIX_MADV_SEQUENTIAL);
+                        src->map = map;
+                        src->map_bytes = (size_t) info.st_size;
+                        src->data = map;
+                        src->pos = (size_t) offset;
+                        src->length = src->map_bytes;
+                        return;
+                }
+                if (map != MAP_FAILED) {
+                        munmap(map, (size_t) info.st_size);
+                }
+        }
+
+        src->block = malloc(BLOCK_BYTES);
+        assert(src->block != NULL);
+        src->data = src->block;
+}
+
+/******** close_source ********
+ *
+ * Release the mapping or block buffer of a source
+ *
+ * Parameters:
+ *      Source *src:    the source
+ * Return:
+ *      nothing
+ * Expects:
+ *      src was set up by open_source
+ * Notes:
+ *      The stream itself is left open
+ ************************/
+static void close_source(Source *src)
+{
+        if (src->map != NULL) {
+                munmap(src->map, src->map_bytes);
+        }
+        free(src->block);
+}
+
+/******** refill ********
+ *
+ * Read the next block of a source that is not mapped
+ *
+ * Parameters:
+ *      Source *src:    the source
+ * Return:
+ *      true if any bytes were read; false at end of input, and always for a
+ *      mapped source
+ * Expects:
+ *      none
+ * Notes:
+ *      Replaces the previous block, so only call once it is used up
+ ************************/
+static bool refill(Source *src)
+{
+        if (src->block == NULL) {
+                return false;
+        }
+
+        src->length = fread(src->block, 1, BLOCK_BYTES, src->fp);
+        src->pos = 0;
+
+        return src->length > 0;
+}
+
+/******** next_byte ********
+ *
+ * Take the next byte of input
+ *
+ * Parameters:
+ *      Source *src:    the source
+ * Return:
+ *      the byte, or EOF at end of input
+ * Expects:
+ *      none
+ * Notes:
+ *      none
+ ************************/
+static int next_byte(Source *src)
+{
+        if (src->pos == src->length && !refill(src)) {
+                return EOF;
+        }
+
+        return src->data[src->pos++];
+}
+
+/******** read_bytes ********
+ *
+ * Copy the next count bytes of input out
+ *
+ * Parameters:
+ *      Source *src:            the source
+ *      unsigned char *bytes:   room for count bytes
+ *      size_t count:           how many to copy
+ * Return:
+ *      nothing
+ * Expects:
+ *      Throws CRE if the input ends first
+ * Notes:
+ *      Copies straight out of the mapping or block, refilling as needed
+ ************************/
+static void read_bytes(Source *src, unsigned char *bytes, size_t count)
+{
+        while (count > 0) {
+                if (src->pos == src->length) {
+                        bool more = refill(src);
+                        assert(more);
+                }
+
+                size_t chunk = src->length - src->pos;
+                if (chunk > count) {
+                        chunk = count;
+                }
+                memcpy(bytes, src->data + src->pos, chunk);
+                src->pos += chunk;
+                bytes += chunk;
+                count -= chunk;
+        }
+}
+
+/******** skip_comment ********
+ *
+ * Skip the rest of a comment, up to and including its newline
+ *
+ * Parameters:
+ *      Source *src:    the source, just past the '#'
+ * Return:
+ *      nothing
+ * Expects:
+ *      none
+ * Notes:
+ *      A comment may also end at end of input
+ ************************/
+static void skip_comment(Source *src)
+{
+        int c;
+
+        do {
+                c = next_byte(src);
+        } while (c != '\n' && c != EOF);
+}
+
+/******** header_int ********
+ *
+ * Read one decimal number from the header
+ *
+ * Parameters:
+ *      Source *src:    the source
+ * Return:
+ *      the number
+ * Expects:
+ *      the number is preceded only by whitespace and comments, and is
+ *      followed by one whitespace byte (or end of input), which is taken
+ *      Throws CRE otherwise, or if it is larger than INT_MAX
+ * Notes:
+ *      Taking exactly one byte after the height leaves a raw image's first
+ *      pixel byte next.
+ ************************/
+static int header_int(Source *src)
+{
+        int c = next_byte(src);
+
+        while (c == '#' || is_space(c)) {
+                if (c == '#') {
+                        skip_comment(src);
+                }
+                c = next_byte(src);
+        }
+        assert(c >= '0' && c <= '9');
+
+        long value = 0;
+        while (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                assert(value <= INT_MAX);
+                c = next_byte(src);
+        }
+        assert(c == EOF || is_space(c));
+
+        return (int) value;
+}
+
+/******** is_space ********
+ *
+ * Tell whether a byte is PBM whitespace
+ *
+ * Parameters:
+ *      int c:          the byte, or EOF
+ * Return:
+ *      true for space, tab, newline, vertical tab, form feed, and return
+ * Expects:
+ *      none
+ * Notes:
+ *      Matches the SWAR test in plain_chunk
+ ************************/
+static bool is_space(int c)
+{
+        return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/******** read_plain ********
+ *
+ * Read the pixels of a plain (P1) image, up to a given row
+ *
+ * Parameters:
+ *      Source *src:    the source, just past the pixels already read
+ *      Sink *sink:     where the pixels go
+ *      int limit:      stop once the rows before this one are complete
+ * Return:
+ *      nothing
+ * Expects:
+ *      sink's width is not 0
+ *      Throws CRE if a byte is not a digit, whitespace or comment, or if
+ *      the input ends before the last pixel
+ * Notes:
+ *      Eight bytes at a time while plain_chunk takes them; one at a time
+ *      otherwise. The last chunk may run past limit, into later rows.
+ ************************/
+static void read_plain(Source *src, Sink *sink, int limit)
+{
+        while (sink->row < limit) {
+                if (src->length - src->pos >= 8 &&
+                    plain_chunk(sink, load_le(src->data + src->pos))) {
+                        src->pos += 8;
+                        continue;
+                }
+
+                int c = next_byte(src);
+                assert(c != EOF);
+
+                if (c == '#') {
+                        skip_comment(src);
+                } else if (c == '0' || c == '1') {
+                        append_bits(sink, (uint64_t) (c - '0'), 1);
+                } else {
+                        assert(is_space(c));
+                }
+        }
+}
+
+/******** plain_chunk ********
+ *
+ * Take eight input bytes as pixels, if they are all digits or whitespace
+ *
+ * Parameters:
+ *      Sink *sink:     where the pixels go
+ *      uint64_t chunk: the bytes, first byte lowest
+ * Return:
+ *      true if the chunk was taken; false, and nothing appended, if it
+ *      holds anything else
+ * Expects:
+ *      none
+ * Notes:
+ *      Each test leaves a byte's high bit set where it holds. A byte is a
+ *      digit when it is '0' or '1' ignoring the low bit, and that low bit
+ *      is its pixel. Whitespace is ' ' or a byte from '\t' to '\r'; the
+ *      range test adds without carries between bytes, since every byte has
+ *      been checked to be ASCII. The usual "0 1 0 1" and "0101" layouts are
+ *      packed with a few shifts; anything else pixel by pixel.
+ ************************/
+static bool plain_chunk(Sink *sink, uint64_t chunk)
+{
+        if ((chunk & HIGH_BITS) != 0) {
+                return false;
+        }
+
+        uint64_t digits = zero_bytes((chunk ^ (LOW_BITS * '0')) &
+                                     (LOW_BITS * 0xfe));
+        uint64_t spaces = zero_bytes(chunk ^ (LOW_BITS * ' ')) |
+                          ((chunk + LOW_BITS * (0x80 - '\t')) &
+                           ~(chunk + LOW_BITS * (0x80 - '\r' - 1)) &
+                           HIGH_BITS);
+
+        if ((digits | spaces) != HIGH_BITS) {
+                return false;
+        }
+
+        unsigned where = gather_high_bits(digits);
+        unsigned bits = gather_high_bits(digits & (chunk << 7));
+
+        if (where == 0xff) {
+                append_bits(sink, bits, 8);
+        } else if (where == 0x55 || where == 0xaa) {
+                bits >>= where == 0xaa;
+                bits = (bits | bits >> 1) & 0x33;
+                bits = (bits | bits >> 2) & 0x0f;
+                append_bits(sink, bits, 4);
+        } else {
+                while (where != 0) {
+                        unsigned lowest = where & -where;
+                        append_bits(sink, (bits & lowest) != 0, 1);
+                        where ^= lowest;
+                }
+        }
+
+        return true;
+}
+
+/******** zero_bytes ********
+ *
+ * Mark the zero bytes of a word
+ *
+ * Parameters:
+ *      uint64_t x:     the word
+ * Return:
+ *      a word with the high bit of each zero byte of x set, and no others
+ * Expects:
+ *      none
+ * Notes:
+ *      Exact: adding 0x7f to the low 7 bits never carries out of a byte
+ ************************/
+static uint64_t zero_bytes(uint64_t x)
+{
+        return ~(((x & LOW_SEVEN) + LOW_SEVEN) | x) & HIGH_BITS;
+}
+
+/******** gather_high_bits ********
+ *
+ * Pack the high bit of each byte into one byte
+ *
+ * Parameters:
+ *      uint64_t x:     a word whose only set bits are byte high bits
+ * Return:
+ *      bit i set when byte i of x has its high bit set
+ * Expects:
+ *      none
+ * Notes:
+ *      One multiply moves every byte's bit into the top byte without the
+ *      partial products overlapping
+ ************************/
+static unsigned gather_high_bits(uint64_t x)
+{
+        return (unsigned) (((x >> 7) * 0x0102040810204080u) >> 56);
+}
+
+/******** append_bits ********
+ *
+ * Add pixels at the sink's current place, storing each row as it fills
+ *
+ * Parameters:
+ *      Sink *sink:     where the pixels go
+ *      uint64_t bits:  the pixels, first pixel lowest
+ *      int count:      how many pixels, 0 to 64
+ * Return:
+ *      nothing
+ * Expects:
+ *      sink's width is not 0, bits has nothing set at or above count
+ * Notes:
+ *      Pixels past the last row are dropped. The row buffer has one spare
+ *      word, so a split across words never needs a bounds check.
+ ************************/
+static void append_bits(Sink *sink, uint64_t bits, int count)
+{
+        while (count > 0 && sink->row < sink->height) {
+                int take = sink->width - sink->col;
+                if (take > count) {
+                        take = count;
+                }
+
+                uint64_t part = take == 64 ? bits :
+                                bits & (((uint64_t) 1 << take) - 1);
+                int word = sink->col / 64;
+                int shift = sink->col % 64;
+
+                sink->words[word] |= part << shift;
+                if (shift != 0) {
+                        sink->words[word + 1] |= part >> (64 - shift);
+                }
+
+                sink->col += take;
+                bits = take == 64 ? 0 : bits >> take;
+                count -= take;
+
+                if (sink->col == sink->width) {
+                        Bit2_put_row(sink->bitmap, sink->row, sink->words);
+                        memset(sink->words, 0, (sink->words_per_row + 1) *
+                                               sizeof(uint64_t));
+                        sink->col = 0;
+                        sink->row++;
+                }
+        }
+}
+
+/******** read_raw ********
+ *
+ * Read the pixels of a raw (P4) image, up to a given row
+ *
+ * Parameters:
+ *      Source *src:    the source, just past the rows already read
+ *      Sink *sink:     where the pixels go
+ *      int limit:      row to stop before
+ * Return:
+ *      nothing
+ * Expects:
+ *      sink's width is not 0
+ *      Throws CRE if the input ends before the last row
+ * Notes:
+ *      Each row is (width + 7) / 8 bytes, first pixel in the high bit of
+ *      the first byte. The bytes land in the row buffer itself and are
+ *      turned into words in place; bits past the width are ignored by
+ *      Bit2_put_row.
+ ************************/
+static void read_raw(Source *src, Sink *sink, int limit)
+{
+        size_t row_bytes = ((size_t) sink->width + 7) / 8;
+        unsigned char *bytes = (unsigned char *) sink->words;
+
+        for (; sink->row < limit; sink->row++) {
+                memset(sink->words, 0, sink->words_per_row *
+                                       sizeof(uint64_t));
+                read_bytes(src, bytes, row_bytes);
+
+                for (int word = 0; word < sink->words_per_row; word++) {
+                        sink->words[word] =
+                                reverse_byte_bits(load_le(bytes + 8 * word));
+                }
+                Bit2_put_row(sink->bitmap, sink->row, sink->words);
+        }
+}
+
+/******** load_le ********
+ *
+ * Load eight bytes as a little-endian word
+ *
+ * Parameters:
+ *      const unsigned char *bytes:     the bytes
+ * Return:
+ *      the word, bytes[0] lowest
+ * Expects:
+ *      bytes has at least 8 readable bytes
+ * Notes:
+ *      Compilers turn this into a single load on little-endian machines,
+ *      and it keeps the byte order right on big-endian ones
+ ************************/
+static uint64_t load_le(const unsigned char *bytes)
+{
+        uint64_t word = 0;
+
+        for (int i = 7; i >= 0; i--) {
+                word = word << 8 | bytes[i];
+        }
+
+        return word;
+}
+
+/******** reverse_byte_bits ********
+ *
+ * Reverse the order of the bits within each byte of a word
+ *
+ * Parameters:
+ *      uint64_t x:     the word
+ * Return:
+ *      x with each byte's bits mirrored, bytes left in place
+ * Expects:
+ *      none
+ * Notes:
+ *      Swaps single bits, then pairs, then nibbles
+ ************************/
+static uint64_t reverse_byte_bits(uint64_t x)
+{
+        x = (x >> 1 & 0x5555555555555555u) | (x & 0x5555555555555555u) << 1;
+        x = (x >> 2 & 0x3333333333333333u) | (x & 0x3333333333333333u) << 2;
+        x = (x >> 4 & 0x0f0f0f0f0f0f0f0fu) | (x & 0x0f0f0f0f0f0f0f0fu) << 4;
+
+        return x;
+}
+
+#undef T
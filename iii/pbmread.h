@@ -0,0 +1,115 @@
+/*
+ *      pbmread.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Interface for reading a PBM straight into a Bit2. Pixels are packed
+ *      into row words as they are scanned, instead of being fetched one at
+ *      a time with Pnmrdr_get and stored with Bit2_put. An image can be
+ *      read whole, or a batch of rows at a time through a Pbmread_T, so
+ *      that early rows can be used while later ones are still arriving.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "bit2.h"
+
+#ifndef PBMREAD_INCLUDED
+#define PBMREAD_INCLUDED
+
+#define T Pbmread_T
+
+typedef struct T *T;
+
+/******** Pbmread_read ********
+ *
+ * Read a plain (P1) or raw (P4) PBM into a new bitmap
+ *
+ * Parameters:
+ *      FILE *fp:       open stream positioned at the start of the image
+ * Return:
+ *      a new heap-allocated Bit2_T holding the image, black pixels as 1
+ * Expects:
+ *      fp is not NULL and the image is a well-formed PBM
+ *      Throws CRE otherwise, if the image ends early, or if allocation
+ *      fails
+ * Notes:
+ *      A regular file is memory-mapped; anything else (a pipe on stdin, for
+ *      one) is read in blocks. Comments ("#" to end of line) are skipped in
+ *      the header and, for P1, between pixels as well. Anything after the
+ *      last pixel is ignored, and fp is left open for the caller to close.
+ ************************/
+Bit2_T Pbmread_read(FILE *fp);
+
+/******** Pbmread_new ********
+ *
+ * Start reading a plain (P1) or raw (P4) PBM a batch of rows at a time
+ *
+ * Parameters:
+ *      FILE *fp:       open stream positioned at the start of the image
+ * Return:
+ *      a new reader, with the header read and an all-white bitmap of the
+ *      image's size ready to be filled in
+ * Expects:
+ *      fp is not NULL and the header is well-formed
+ *      Throws CRE otherwise, or if allocation fails
+ * Notes:
+ *      fp must stay open until the reader is freed
+ ************************/
+T Pbmread_new(FILE *fp);
+
+/******** Pbmread_free ********
+ *
+ * Deallocates a reader, but not its bitmap
+ *
+ * Parameters:
+ *      T *reader:      pointer to the Pbmread_T to free
+ * Return:
+ *      Nothing, *reader is set to NULL
+ * Expects:
+ *      reader and *reader are not NULL
+ *      Throws CRE if NULL pointers
+ * Notes:
+ *      The bitmap from Pbmread_bitmap belongs to the caller and stays
+ *      valid; fp is left open
+ ************************/
+void Pbmread_free(T *reader);
+
+/******** Pbmread_bitmap ********
+ *
+ * Returns the bitmap a reader fills in
+ *
+ * Parameters:
+ *      T reader:       Pbmread_T instance
+ * Return:
+ *      the bitmap; rows below the count from Pbmread_more are complete
+ * Expects:
+ *      reader is not NULL
+ *      Throws CRE if NULL pointer
+ ************************/
+Bit2_T Pbmread_bitmap(T reader);
+
+/******** Pbmread_more ********
+ *
+ * Read at least the next rows rows of the image, or up to its end
+ *
+ * Parameters:
+ *      T reader:       Pbmread_T instance
+ *      int rows:       how many more rows to finish
+ * Return:
+ *      the number of rows of the bitmap now complete, from the top
+ * Expects:
+ *      reader is not NULL, rows >= 0
+ *      Throws CRE otherwise, or if the image is malformed or ends early
+ * Notes:
+ *      Later calls only write rows at or past the returned count, and Bit2
+ *      rows never share a word, so another thread may use the complete
+ *      rows meanwhile. A plain image may complete a few more rows than
+ *      asked for.
+ ************************/
+int Pbmread_more(T reader, int rows);
+
+#undef T
+#endif
@@ -0,0 +1,376 @@
+/*
+ *      pbmwrite.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of PBM output. A raw (P4) row is (width + 7) / 8
+ *      bytes with the first pixel in the high bit of the first byte; a Bit2
+ *      row keeps the first pixel in the low bit of its first word. Mirroring
+ *      each byte's bits and storing each word little-endian turns one into
+ *      the other, and Bit2's zero padding gives the zero fill bits P4 wants.
+ *
+ *      A plain (P1) row is two characters per pixel, the digit and a space,
+ *      with the space after the row's last pixel turned into a newline (or
+ *      dropped, after the image's last pixel). Each byte of a row word is
+ *      eight pixels, so a 256-entry table of 16-character strings encodes
+ *      eight pixels with one copy.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "pbmwrite.h"
+#include "assert.h"
+
+/* Bytes of plain text gathered before each write(2) */
+#define PLAIN_BUFFER_BYTES (1 << 20)
+
+/* Pixels of a row encoded at a time by Pbmwrite_plain_row */
+#define ROW_CHUNK_PIXELS 2048
+
+/* Text of each byte of pixels, first pixel in the low bit: "0 1 0 ..." */
+static char plain_text[256][16];
+static bool plain_text_built = false;
+
+static void store_le(unsigned char *bytes, uint64_t word);
+static uint64_t reverse_byte_bits(uint64_t x);
+static void build_plain_text(void);
+static void encode_plain(const uint64_t *words, int first, int count,
+                         char *text);
+static size_t encode_plain_row(const uint64_t *words, int width, bool last,
+                               char *text);
+static void write_all(int fd, const char *bytes, size_t count);
+
+/******** Pbmwrite_raw ********
+ *
+ * Write a whole bitmap as a raw (P4) PBM, header included
+ *
+ * Parameters:
+ *      FILE *fp:       stream to write to
+ *      Bit2_T bitmap:  the image, black pixels as 1
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and bitmap are not NULL
+ *      Throws CRE otherwise, if malloc fails, or if a write fails
+ * Notes:
+ *      Each row is copied out with Bit2_get_row into one reused buffer
+ ************************/
+void Pbmwrite_raw(FILE *fp, Bit2_T bitmap)
+{
+        assert(fp != NULL && bitmap != NULL);
+
+        int width = Bit2_width(bitmap);
+        int height = Bit2_height(bitmap);
+        uint64_t *words = malloc((Bit2_words_per_row(bitmap) + 1) *
+                                 sizeof(uint64_t));
+        assert(words != NULL);
+
+        int written = fprintf(fp, "P4\n%d %d\n", width, height);
+        assert(written > 0);
+
+        for (int row = 0; row < height; row++) {
+                Bit2_get_row(bitmap, row, words);
+                Pbmwrite_raw_row(fp, words, width);
+        }
+
+        free(words);
+}
+
+/******** Pbmwrite_raw_row ********
+ *
+ * Write one packed row as the bytes of a raw (P4) PBM row
+ *
+ * Parameters:
+ *      FILE *fp:               stream to write to
+ *      uint64_t *words:        the row, laid out as Bit2_get_row fills it
+ *                              in; overwritten
+ *      int width:              number of pixels in the row
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and words are not NULL, width >= 0, and the bits of words past
+ *      width are 0
+ *      Throws CRE otherwise, or if the write fails
+ * Notes:
+ *      Each word is converted where it sits, so the row goes out in one
+ *      fwrite.
+ ************************/
+void Pbmwrite_raw_row(FILE *fp, uint64_t *words, int width)
+{
+        assert(fp != NULL && words != NULL && width >= 0);
+
+        size_t bytes = ((size_t) width + 7) / 8;
+        int nwords = (width + 63) / 64;
+
+        for (int word = 0; word < nwords; word++) {
+                store_le((unsigned char *) &words[word],
+                         reverse_byte_bits(words[word]));
+        }
+
+        size_t written = fwrite(words, 1, bytes, fp);
+        assert(written == bytes);
+}
+
+/******** Pbmwrite_plain ********
+ *
+ * Write a whole bitmap as a plain (P1) PBM, header included
+ *
+ * Parameters:
+ *      FILE *fp:       stream to write to
+ *      Bit2_T bitmap:  the image, black pixels as 1
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and bitmap are not NULL
+ *      Throws CRE otherwise, if malloc fails, or if a write fails
+ * Notes:
+ *      Rows are encoded one after another into one buffer, which is written
+ *      whenever the next row might not fit. The buffer always holds at
+ *      least one whole row.
+ ************************/
+void Pbmwrite_plain(FILE *fp, Bit2_T bitmap)
+{
+        assert(fp != NULL && bitmap != NULL);
+
+        int width = Bit2_width(bitmap);
+        int height = Bit2_height(bitmap);
+        size_t row_bytes = 2 * (size_t) width;
+        size_t capacity = row_bytes > PLAIN_BUFFER_BYTES ? row_bytes :
+                                                           PLAIN_BUFFER_BYTES;
+        uint64_t *words = malloc((Bit2_words_per_row(bitmap) + 1) *
+                                 sizeof(uint64_t));
+        char *text = malloc(capacity);
+        assert(words != NULL && text != NULL);
+
+        int written = fprintf(fp, "P1\n%d %d\n", width, height);
+        int flushed = fflush(fp);
+        assert(written > 0 && flushed == 0);
+
+        int fd = fileno(fp);
+        size_t used = 0;
+
+        for (int row = 0; row < height && width > 0; row++) {
+                if (capacity - used < row_bytes) {
+                        write_all(fd, text, used);
+                        used = 0;
+                }
+
+                Bit2_get_row(bitmap, row, words);
+                used += encode_plain_row(words, width, row == height - 1,
+                                         text + used);
+        }
+        write_all(fd, text, used);
+
+        free(text);
+        free(words);
+}
+
+/******** Pbmwrite_plain_row ********
+ *
+ * Write one packed row as the text of a plain (P1) PBM row
+ *
+ * Parameters:
+ *      FILE *fp:               stream to write to
+ *      const uint64_t *words:  the row, laid out as Bit2_get_row fills it in
+ *      int width:              number of pixels in the row
+ *      bool last:              whether this is the image's last row
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and words are not NULL, width >= 0
+ *      Throws CRE otherwise, or if the write fails
+ * Notes:
+ *      Encodes ROW_CHUNK_PIXELS at a time into a local buffer, so a row of
+ *      any width needs no allocation; fp's own buffering batches the writes.
+ ************************/
+void Pbmwrite_plain_row(FILE *fp, const uint64_t *words, int width,
+                        bool last)
+{
+        assert(fp != NULL && words != NULL && width >= 0);
+
+        char text[2 * ROW_CHUNK_PIXELS];
+
+        for (int first = 0; first < width; first += ROW_CHUNK_PIXELS) {
+                int count = width - first;
+                size_t length;
+
+                if (count > ROW_CHUNK_PIXELS) {
+                        count = ROW_CHUNK_PIXELS;
+                        encode_plain(words, first, count, text);
+                        length = 2 * (size_t) count;
+                } else {
+                        length = encode_plain_row(words + first / 64, count,
+                                                  last, text);
+                }
+
+                size_t written = fwrite(text, 1, length, fp);
+                assert(written == length);
+        }
+}
+
+/******** build_plain_text ********
+ *
+ * Fill in the byte-to-text table, the first time it is needed
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      nothing
+ * Expects:
+ *      none
+ * Notes:
+ *      4 KB, built once per run
+ ************************/
+static void build_plain_text(void)
+{
+        if (plain_text_built) {
+                return;
+        }
+
+        for (int byte = 0; byte < 256; byte++) {
+                for (int bit = 0; bit < 8; bit++) {
+                        plain_text[byte][2 * bit] = '0' + ((byte >> bit) & 1);
+                        plain_text[byte][2 * bit + 1] = ' ';
+                }
+        }
+        plain_text_built = true;
+}
+
+/******** encode_plain ********
+ *
+ * Turn pixels of a packed row into digits, each followed by a space
+ *
+ * Parameters:
+ *      const uint64_t *words:  the row
+ *      int first:              first pixel, a multiple of 8
+ *      int count:              how many pixels
+ *      char *text:             room for 2 * count characters
+ * Return:
+ *      nothing
+ * Expects:
+ *      words holds at least first + count pixels
+ * Notes:
+ *      Whole bytes of pixels are one 16-character copy from the table; a
+ *      last partial byte copies just its share of its entry.
+ ************************/
+static void encode_plain(const uint64_t *words, int first, int count,
+                         char *text)
+{
+        build_plain_text();
+
+        for (int done = 0; done < count; done += 8) {
+                int col = first + done;
+                unsigned byte = (unsigned) (words[col / 64] >> (col % 64)) &
+                                0xff;
+                int pixels = count - done < 8 ? count - done : 8;
+
+                memcpy(text + 2 * done, plain_text[byte], 2 * pixels);
+        }
+}
+
+/******** encode_plain_row ********
+ *
+ * Turn a whole packed row into plain text, with its line ending
+ *
+ * Parameters:
+ *      const uint64_t *words:  the row
+ *      int width:              number of pixels, at least 1
+ *      bool last:              whether this is the image's last row
+ *      char *text:             room for 2 * width characters
+ * Return:
+ *      number of characters stored
+ * Expects:
+ *      none
+ * Notes:
+ *      The space after the last pixel becomes the newline, or is dropped
+ *      on the last row.
+ ************************/
+static size_t encode_plain_row(const uint64_t *words, int width, bool last,
+                               char *text)
+{
+        size_t length = 2 * (size_t) width;
+
+        encode_plain(words, 0, width, text);
+        if (last) {
+                return length - 1;
+        }
+        text[length - 1] = '\n';
+
+        return length;
+}
+
+/******** write_all ********
+ *
+ * Write bytes to a descriptor, retrying short and interrupted writes
+ *
+ * Parameters:
+ *      int fd:                 descriptor to write to
+ *      const char *bytes:      the bytes
+ *      size_t count:           how many
+ * Return:
+ *      nothing
+ * Expects:
+ *      Throws CRE if a write fails
+ * Notes:
+ *      none
+ ************************/
+static void write_all(int fd, const char *bytes, size_t count)
+{
+        while (count > 0) {
+                ssize_t written = write(fd, bytes, count);
+
+                if (written < 0 && errno == EINTR) {
+                        continue;
+                }
+                assert(written > 0);
+                bytes += written;
+                count -= (size_t) written;
+        }
+}
+
+/******** store_le ********
+ *
+ * Store a word as eight little-endian bytes
+ *
+ * Parameters:
+ *      unsigned char *bytes:   room for 8 bytes
+ *      uint64_t word:          the word
+ * Return:
+ *      nothing
+ * Expects:
+ *      bytes is not NULL
+ * Notes:
+ *      Compilers turn this into a single store on little-endian machines
+ ************************/
+static void store_le(unsigned char *bytes, uint64_t word)
+{
+        for (int i = 0; i < 8; i++) {
+                bytes[i] = (unsigned char) (word >> (8 * i));
+        }
+}
+
+/******** reverse_byte_bits ********
+ *
+ * Reverse the order of the bits within each byte of a word
+ *
+ * Parameters:
+ *      uint64_t x:     the word
+ * Return:
+ *      x with each byte's bits mirrored, bytes left in place
+ * Expects:
+ *      none
+ * Notes:
+ *      Swaps single bits, then pairs, then nibbles
+ ************************/
+static uint64_t reverse_byte_bits(uint64_t x)
+{
+        x = (x >> 1 & 0x5555555555555555u) | (x & 0x5555555555555555u) << 1;
+        x = (x >> 2 & 0x3333333333333333u) | (x & 0x3333333333333333u) << 2;
+        x = (x >> 4 & 0x0f0f0f0f0f0f0f0fu) | (x & 0x0f0f0f0f0f0f0f0fu) << 4;
+
+        return x;
+}
@@ -0,0 +1,99 @@
+/*
+ *      pbmwrite.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Interface for writing Bit2 bitmaps as PBMs. Raw (P4) rows are the
+ *      packed row words with each byte's bit order reversed, so they are
+ *      written a word at a time, with no per-pixel work. Plain (P1) rows
+ *      are made eight pixels at a time from a byte-to-text table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bit2.h"
+
+#ifndef PBMWRITE_INCLUDED
+#define PBMWRITE_INCLUDED
+
+/******** Pbmwrite_raw ********
+ *
+ * Write a whole bitmap as a raw (P4) PBM, header included
+ *
+ * Parameters:
+ *      FILE *fp:       stream to write to
+ *      Bit2_T bitmap:  the image, black pixels as 1
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and bitmap are not NULL
+ *      Throws CRE otherwise, if malloc fails, or if a write fails
+ ************************/
+void Pbmwrite_raw(FILE *fp, Bit2_T bitmap);
+
+/******** Pbmwrite_raw_row ********
+ *
+ * Write one packed row as the bytes of a raw (P4) PBM row
+ *
+ * Parameters:
+ *      FILE *fp:               stream to write to
+ *      uint64_t *words:        the row, laid out as Bit2_get_row fills it
+ *                              in; overwritten
+ *      int width:              number of pixels in the row
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and words are not NULL, width >= 0, and the bits of words past
+ *      width are 0
+ *      Throws CRE otherwise, or if the write fails
+ * Notes:
+ *      For writers that produce a row at a time, after their own "P4"
+ *      header. The words are turned into bytes in place.
+ ************************/
+void Pbmwrite_raw_row(FILE *fp, uint64_t *words, int width);
+
+/******** Pbmwrite_plain ********
+ *
+ * Write a whole bitmap as a plain (P1) PBM, header included
+ *
+ * Parameters:
+ *      FILE *fp:       stream to write to
+ *      Bit2_T bitmap:  the image, black pixels as 1
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and bitmap are not NULL
+ *      Throws CRE otherwise, if malloc fails, or if a write fails
+ * Notes:
+ *      Pixels are separated by spaces and rows by newlines, with nothing
+ *      after the last pixel. The text is built in a large buffer and
+ *      handed straight to write(2) on fp's descriptor, after flushing fp.
+ ************************/
+void Pbmwrite_plain(FILE *fp, Bit2_T bitmap);
+
+/******** Pbmwrite_plain_row ********
+ *
+ * Write one packed row as the text of a plain (P1) PBM row
+ *
+ * Parameters:
+ *      FILE *fp:               stream to write to
+ *      const uint64_t *words:  the row, laid out as Bit2_get_row fills it in
+ *      int width:              number of pixels in the row
+ *      bool last:              whether this is the image's last row
+ * Return:
+ *      Nothing
+ * Expects:
+ *      fp and words are not NULL, width >= 0
+ *      Throws CRE otherwise, or if the write fails
+ * Notes:
+ *      For writers that produce a row at a time, after their own "P1"
+ *      header. The layout matches Pbmwrite_plain: a newline ends every row
+ *      but the last.
+ ************************/
+void Pbmwrite_plain_row(FILE *fp, const uint64_t *words, int width,
+                        bool last);
+
+#endif
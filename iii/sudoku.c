@@ -18,9 +18,9 @@ FILE *openFile(int argc, char *argv[]);
 bool pgm_invalid(Pnmrdr_mapdata data);
 bool check_sudoku(UArray2_T sudoku);
 void populate(int col, int row, UArray2_T uarray2, void *val_vp, void *rdr_vp);
-void check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
-void check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
-void check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
+bool check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
+bool check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
+bool check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
 void check_tracking_array(int number, bool *tracking_arr);
 
 /******** main ********
@@ -135,16 +135,14 @@ FILE *openFile(int argc, char *argv[])
  *      true if invalid format
  *      false if correctly formatted
  * Expects:
- *      data is not NULL
  *      file data is of type P2 for PGM
  * Notes: 
- *      Only the NULL and P2 conditions result in CRE.
+ *      Only the P2 condition results in CRE.
  *      The improper width, height, and denominator is just bad Sudoku, so we
  *      signal to exit with EXIT_FAILURE
  ************************/
 bool pgm_invalid(Pnmrdr_mapdata data)
 {
-        assert(data != NULL);
         assert(data.type == 2);
 
         if (data.width != 9 || data.height != 9 || data.denominator != 9) {
@@ -208,6 +206,8 @@ void populate(int col, int row, UArray2_T uarray2, void *val_vp, void *rdr_vp)
  *      sudoku is not NULL. Throws CRE otherwise.
  * Notes: 
  *      Checks if the sudoku is valid rowwise, columnwise, and boxwise.
+ *      Each pass stops at the first repeated digit, and later passes are
+ *      skipped once the answer is known.
  *      Frees memory of UArray2 which was allocated back in initalizeSudoku
  ************************/
 bool check_sudoku(UArray2_T sudoku)
@@ -223,17 +223,14 @@ bool check_sudoku(UArray2_T sudoku)
         bool tracking[28] = { false };
 
         /* Check rows, columns, and boxes in that order */
-        UArray2_map_row_major(sudoku, check_row, tracking);
-        UArray2_map_col_major(sudoku, check_col, tracking);
-        UArray2_map_row_major(sudoku, check_box, tracking);
+        bool invalid =
+                UArray2_map_row_major_until(sudoku, check_row, tracking) ||
+                UArray2_map_col_major_until(sudoku, check_col, tracking) ||
+                UArray2_map_row_major_until(sudoku, check_box, tracking);
 
         UArray2_free(&sudoku);
         
-        if (tracking[0]) {
-                return false;
-        } else {
-                return true;
-        }
+        return !invalid;
 }
 
 /******** check_row ********
@@ -247,13 +244,13 @@ bool check_sudoku(UArray2_T sudoku)
  *      void *val_vp:           void pointer to value at (col, row)
  *      void *cl:               closure pointer that points to tracking array
  * Return: 
- *      none
+ *      true if a repeated digit was found, to stop the traversal
  * Expects:
  *      val_vp and cl are not NULL. Otherwise throws CRE.
  * Notes:
  *      none
  ************************/
-void check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
+bool check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
 {
         assert(val_vp != NULL && cl != NULL);
         
@@ -263,11 +260,6 @@ void check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
         /* Convert closure to boolean type use */        
         bool *tracking_arr = cl;
 
-        /* If ever an invalid sudoku, don't waste computation */
-        if (tracking_arr[0]) {
-                return;
-        }
-
         /* At start of row, reset tracking array */
         if (col == 0) {
                 for (int i = 1; i < 10; i++) {
@@ -277,6 +269,8 @@ void check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
 
         /* Check if number has been seen */
         check_tracking_array(*(int *)val_vp, tracking_arr);
+
+        return tracking_arr[0];
 }
 
 /******** check_col ********
@@ -290,13 +284,13 @@ void check_row(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
  *      void *val_vp:           void pointer to value at (col, row)
  *      void *cl:               closure pointer that points to tracking array
  * Return: 
- *      none
+ *      true if a repeated digit was found, to stop the traversal
  * Expects:
  *      val_vp and cl are not NULL. Otherwise throws CRE.
  * Notes:
  *      none
  ************************/
-void check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
+bool check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
 {
         assert(val_vp != NULL && cl != NULL);
 
@@ -306,11 +300,6 @@ void check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
         /* Convert closure to boolean type use */        
         bool *tracking_arr = cl;
 
-        /* If ever an invalid sudoku, don't waste computation */
-        if (tracking_arr[0]) {
-                return;
-        }
-
         /* At start of column, reset tracking array */
         if (row == 0) {
                 for (int i = 1; i < 10; i++) {
@@ -320,6 +309,8 @@ void check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
 
         /* Check if number has been seen */
         check_tracking_array(*(int *)val_vp, tracking_arr);
+
+        return tracking_arr[0];
 }
 
 /******** check_box ********
@@ -333,7 +324,7 @@ void check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
  *      void *val_vp:           void pointer to value at (col, row)
  *      void *cl:               closure pointer that points to tracking array
  * Return: 
- *      none
+ *      true if a repeated digit was found, to stop the traversal
  * Expects:
  *      val_vp and cl are not NULL. Otherwise throws CRE.
  * Notes:
@@ -345,7 +336,7 @@ void check_col(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
  *      For example:
  *      number 3 for box 2 will be at tracking_array[3 + 9]
  ************************/
-void check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
+bool check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
 {
         assert(val_vp != NULL && cl != NULL);
         (void) uarray2;
@@ -353,11 +344,6 @@ void check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
         /* Convert closure to boolean type use */        
         bool *tracking_arr = cl;
 
-        /* If ever an invalid sudoku, don't waste computation */
-        if (tracking_arr[0]) {
-                return;
-        }
-
         /* At start of new box section, reset tracking array */
         if ((row % 3) == 0) {
                 for (int i = 1; i < 28; i++) {
@@ -375,6 +361,8 @@ void check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
                 /* Check if number is seen in box 3 */
                 check_tracking_array(*(int *)val_vp + 18, tracking_arr);
         }
+
+        return tracking_arr[0];
 }
 
 /******** check_tracking_array ********
@@ -385,10 +373,11 @@ void check_box(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
  *
  * Parameters:
  *      int number: number being checked
+ *      bool *tracking_arr: seen flags, with the invalid flag in slot 0
  * Return: 
  *      none
  * Expects:
- *      val_vp and cl are not NULL. Otherwise throws CRE.
+ *      tracking_arr is not NULL.
  * Notes:
  *      This takes advantage of the logic explained in check_box
  ************************/
@@ -7,7 +7,14 @@
  *      Interface for two-dimensional bit arrays
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <unistd.h>
+#include <limits.h>
+#include <string.h>
 #include "uarray2.h"
+#include "mapfile.h"
 #include "assert.h"
 
 #define T UArray2_T
@@ -17,9 +24,46 @@ struct T
         int width;
         int height;
         int size;
-        UArray_T array;
+        Arena_T arena;
+        void *map;
+        size_t map_bytes;
+        char *elems;
 };
 
+/* Identifies a UArray2 grid file and its payload layout */
+#define MAP_MAGIC "UARRAY2"
+#define MAP_VERSION 1
+
+/*
+ * Bytes reserved for the header in front of the cells. Rounded up to 16 so
+ * the cells are aligned for any element type.
+ */
+#define HEADER_BYTES ((sizeof(struct T) + 15) & ~(size_t) 15)
+
+/* Bytes of source cells copied per tile by the transforms */
+#define TILE_BYTES (16 * 1024)
+
+/* One worker's share of a parallel map: a band of rows or columns */
+typedef struct band {
+        T uarray2;
+        int first;
+        int last;
+        void (*apply)(int col, int row, T a, void *p1, void *p2);
+        void *cl;
+        pthread_t thread;
+} Band;
+
+static size_t payload_bytes(int width, int height, int size);
+static T new_in_block(char *block, int width, int height, int size,
+                       Arena_T arena);
+static T new_mapped(char *map, size_t bytes, int width, int height, int size);
+static void parallel_map(T uarray2, int nthreads, bool by_row,
+        void apply(int col, int row, T a, void *p1, void *p2),
+        void *init(void *cl), void merge(void *cl, void *local), void *cl);
+static void *map_row_band(void *band_vp);
+static void *map_col_band(void *band_vp);
+static T remap(T src, bool swap, bool mirror_cols, bool mirror_rows);
+
 /******** UArray2_new ********
  *
  * Allocates space for a UArray2 if width and height are non-negative and size
@@ -37,20 +81,214 @@ struct T
  *      throws a CRE if an invalid input is given
  * Notes:
  *      throws a CRE if malloc fails
+ *      The header and the cells share one zeroed allocation.
  ************************/
 T UArray2_new(int width, int height, int size)
 {       
         assert(0 <= width && 0 <= height && 0 < size);
 
-        /* Make a UArray object */
+        /* Header and cells in one block */
+        char *block = calloc(1, HEADER_BYTES +
+                             payload_bytes(width, height, size));
+        assert(block != NULL);
+
+        return new_in_block(block, width, height, size, NULL);
+}
+
+/******** UArray2_new_in ********
+ *
+ * Allocates a UArray2 like UArray2_new, but takes its single block of memory
+ * from a client-supplied Hanson arena instead of malloc.
+ *
+ * Parameters:
+ *      int width: the width of the array to be created
+ *      int height: the height of the array to be created
+ *      int size: the number of bytes per cell in the array
+ *      Arena_T arena: the arena that owns the array's memory
+ * Return: 
+ *      a struct pointer to the instance of the new UArray
+ * Expects:
+ *      width and height are nonnegative
+ *      size is positive
+ *      arena is not NULL
+ *      throws a CRE if an invalid input is given
+ * Notes:
+ *      Arena_calloc raises Arena_Failed if it runs out of memory
+ ************************/
+T UArray2_new_in(int width, int height, int size, Arena_T arena)
+{
+        assert(0 <= width && 0 <= height && 0 < size && arena != NULL);
+
+        size_t bytes = HEADER_BYTES + payload_bytes(width, height, size);
+        assert(bytes <= LONG_MAX);
+
+        char *block = Arena_calloc(arena, 1, (long) bytes, __FILE__,
+                                   __LINE__);
+
+        return new_in_block(block, width, height, size, arena);
+}
+
+/******** UArray2_new_mapped ********
+ *
+ * Allocates a UArray2 whose cells live in a memory-mapped file rather than on
+ * the heap. The file is created (or truncated) and laid out as described in
+ * mapfile.h, with the cells stored row-major as the payload.
+ *
+ * Parameters:
+ *      const char *path: file to hold the cells
+ *      int width: the width of the array to be created
+ *      int height: the height of the array to be created
+ *      int size: the number of bytes per cell in the array
+ * Return: 
+ *      a struct pointer to the instance of the new UArray
+ * Expects:
+ *      path is not NULL
+ *      width and height are nonnegative
+ *      size is positive
+ *      throws a CRE if an invalid input is given or the file cannot be
+ *      created and mapped
+ * Notes:
+ *      All cells start out zero
+ ************************/
+T UArray2_new_mapped(const char *path, int width, int height, int size)
+{
+        assert(path != NULL && 0 <= width && 0 <= height && 0 < size);
+
+        Mapfile_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+        header.version = MAP_VERSION;
+        header.size = size;
+        header.width = width;
+        header.height = height;
+
+        size_t payload = payload_bytes(width, height, size);
+        char *map = Mapfile_create(path, header, payload);
+
+        return new_mapped(map, MAPFILE_HEADER_BYTES + payload, width, height,
+                          size);
+}
+
+/******** UArray2_open_mapped ********
+ *
+ * Maps an existing grid file made by UArray2_new_mapped. If writable,
+ * changes to the cells are written back to the file.
+ *
+ * Parameters:
+ *      const char *path: grid file to open
+ *      bool writable: whether changes should reach the file
+ * Return: 
+ *      a struct pointer to a UArray2 over the file's cells
+ * Expects:
+ *      path is not NULL
+ *      throws a CRE if the file cannot be mapped or is not a UArray2 grid
+ *      file of a consistent length
+ * Notes:
+ *      Nothing is read up front; pages are faulted in as cells are touched.
+ *      A file opened with writable false only needs read permission; the
+ *      array can still be changed, but only in this process's copy.
+ ************************/
+T UArray2_open_mapped(const char *path, bool writable)
+{
+        Mapfile_header header;
+        size_t bytes;
+        char *map = Mapfile_open(path, MAP_MAGIC, MAP_VERSION, writable,
+                                 &header, &bytes);
+
+        assert(header.width <= INT_MAX && header.height <= INT_MAX &&
+               0 < header.size && header.size <= INT_MAX);
+        assert(bytes == MAPFILE_HEADER_BYTES +
+                        payload_bytes(header.width, header.height,
+                                      header.size));
+
+        return new_mapped(map, bytes, header.width, header.height,
+                          header.size);
+}
+
+/******** new_mapped ********
+ *
+ * Make a heap header for cells that live in a mapped grid file
+ *
+ * Parameters:
+ *      char *map:              start of the mapping
+ *      size_t bytes:           length of the mapping
+ *      int width, int height, int size: dimensions of the array
+ * Return: 
+ *      the new UArray2
+ * Expects:
+ *      map is not NULL
+ * Notes:
+ *      throws a CRE if malloc fails
+ ************************/
+static T new_mapped(char *map, size_t bytes, int width, int height, int size)
+{
         T arr2d = malloc(sizeof(*arr2d));
         assert(arr2d != NULL);
 
-        /* populate struct */
         arr2d->width = width;
         arr2d->height = height;
         arr2d->size = size;
-        arr2d->array = UArray_new(width * height, size);
+        arr2d->arena = NULL;
+        arr2d->map = map;
+        arr2d->map_bytes = bytes;
+        arr2d->elems = map + MAPFILE_HEADER_BYTES;
+
+        return arr2d;
+}
+
+/******** payload_bytes ********
+ *
+ * Number of bytes needed for width * height cells of size bytes each
+ *
+ * Parameters:
+ *      int width, int height, int size: dimensions of the array
+ * Return: 
+ *      width * height * size, computed in size_t
+ * Expects:
+ *      width and height are nonnegative, size is positive
+ *      throws a CRE if the product (plus room for a header) does not fit in
+ *      a size_t
+ * Notes:
+ *      Each dimension is an int, so the product itself can reach about
+ *      2^62 cells; only the total is wide.
+ ************************/
+static size_t payload_bytes(int width, int height, int size)
+{
+        size_t cells = (size_t) width * (size_t) height;
+        assert(height == 0 || cells / (size_t) height == (size_t) width);
+        assert(cells <= (SIZE_MAX - HEADER_BYTES -
+                         MAPFILE_HEADER_BYTES) / (size_t) size);
+
+        return cells * (size_t) size;
+}
+
+/******** new_in_block ********
+ *
+ * Lay out a UArray2 in a zeroed block: header first, cells right after it
+ *
+ * Parameters:
+ *      char *block:    zeroed memory of HEADER_BYTES + width * height * size
+ *      int width, int height, int size: dimensions of the array
+ *      Arena_T arena:  arena that owns block, or NULL if it came from malloc
+ * Return: 
+ *      the new UArray2, which lives at the start of block
+ * Expects:
+ *      block is not NULL
+ * Notes:
+ *      none
+ ************************/
+static T new_in_block(char *block, int width, int height, int size,
+                       Arena_T arena)
+{
+        T arr2d = (T) block;
+
+        arr2d->width = width;
+        arr2d->height = height;
+        arr2d->size = size;
+        arr2d->arena = arena;
+        arr2d->map = NULL;
+        arr2d->map_bytes = 0;
+        arr2d->elems = block + HEADER_BYTES;
 
         return arr2d;
 }
@@ -62,22 +300,27 @@ T UArray2_new(int width, int height, int size)
  * Parameters:
  *      *uarray2: pointer value of uarray object
  * Return: 
- *      Nothing, but Hanson's UArray_free will signal that uarray2 points to
- *      freed memory at end of successful function call
+ *      Nothing, *uarray2 is set to NULL
  * Expects:
- *      CRE if uarray2 or *uarray2 are NULL (plan to check if thrown by Hanson)
+ *      CRE if uarray2 or *uarray2 are NULL
  * Notes:
- *      None
+ *      An array made by UArray2_new_in is owned by its arena, so its memory
+ *      is only recycled when the client calls Arena_free or Arena_dispose.
+ *      A mapped array is unmapped; its cells stay in the file.
  ************************/
 void UArray2_free(T *uarray2)
 {
         assert(uarray2 != NULL && *uarray2 != NULL);
 
-        /* Free 1D array */
-        UArray_free(&(*uarray2)->array);
+        if ((*uarray2)->map != NULL) {
+                Mapfile_close((*uarray2)->map, (*uarray2)->map_bytes);
+                free(*uarray2);
+        } else if ((*uarray2)->arena == NULL) {
+                /* Header and cells are one block */
+                free(*uarray2);
+        }
 
-        /* free actual struct */
-        free(*uarray2);
+        *uarray2 = NULL;
 }
 
 /******** UArray2_width ********
@@ -144,8 +387,8 @@ int UArray2_size(T uarray2)
 
 /******** UArray2_at ********
  *
- * Client requests UArray2_at(col, row). Under the hood, we are actually going
- * for 1D Uarray which can be accessed at UArray_at(row * width + col).
+ * Client requests UArray2_at(col, row). Under the hood, the cells are one
+ * row-major block, so the cell is at offset (row * width + col) * size.
  *
  * Parameters:
  *      uarray2: address value of uarray object
@@ -154,7 +397,7 @@ int UArray2_size(T uarray2)
  * Return: 
  *      void pointer to value stored at (col, row) 2D or (row * width + col) 1D
  * Expects:
- *      CRE if uarray2 is NULL (thrown by Hanson)
+ *      CRE if uarray2 is NULL
  *      col and row are within [0, width - 1] and [0, height - 1] respectively
  * Notes:
  *      none
@@ -164,7 +407,117 @@ void *UArray2_at(T uarray2, int col, int row)
         assert(uarray2 != NULL && 0 <= col && col < uarray2->width && 0 <= row
                 && row < uarray2->height);
 
-        return UArray_at(uarray2->array, row * uarray2->width + col);
+        return uarray2->elems + ((size_t) row * uarray2->width + col) *
+               uarray2->size;
+}
+
+/******** UArray2_row ********
+ *
+ * Return a pointer to the first cell of a row. The cells of a row are
+ * contiguous, so cell (col, row) lives at (char *)base + col * size.
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ *      int row: the row requested
+ * Return:
+ *      void pointer to cell (0, row), or NULL if the array has no columns
+ * Expects:
+ *      uarray2 is not NULL
+ *      row is within [0, height - 1]
+ *      CRE otherwise
+ * Notes:
+ *      none
+ ************************/
+void *UArray2_row(T uarray2, int row)
+{
+        assert(uarray2 != NULL && 0 <= row && row < uarray2->height);
+
+        if (uarray2->width == 0) {
+                return NULL;
+        }
+
+        return uarray2->elems + (size_t) row * uarray2->width * uarray2->size;
+}
+
+/******** UArray2_stride ********
+ *
+ * Return the number of bytes between the start of one row and the next
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ * Return:
+ *      width * size
+ * Expects:
+ *      uarray2 is not NULL
+ *      CRE if uarray2 is NULL
+ * Notes:
+ *      none
+ ************************/
+size_t UArray2_stride(T uarray2)
+{
+        assert(uarray2 != NULL);
+
+        return (size_t) uarray2->width * uarray2->size;
+}
+
+/******** UArray2_row_span ********
+ *
+ * Return a span covering every cell of one row
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ *      int row: the row requested
+ * Return:
+ *      span with count == width and stride == size
+ * Expects:
+ *      uarray2 is not NULL
+ *      row is within [0, height - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2_row_span(T uarray2, int row)
+{
+        UArray2_span span;
+
+        span.base = UArray2_row(uarray2, row);
+        span.count = uarray2->width;
+        span.stride = uarray2->size;
+
+        return span;
+}
+
+/******** UArray2_col_span ********
+ *
+ * Return a span covering every cell of one column
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ *      int col: the column requested
+ * Return:
+ *      span with count == height and stride == UArray2_stride(uarray2)
+ * Expects:
+ *      uarray2 is not NULL
+ *      col is within [0, width - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2_col_span(T uarray2, int col)
+{
+        assert(uarray2 != NULL && 0 <= col && col < uarray2->width);
+
+        UArray2_span span;
+
+        span.base = NULL;
+        span.count = uarray2->height;
+        span.stride = UArray2_stride(uarray2);
+
+        if (span.count > 0) {
+                span.base = UArray2_at(uarray2, col, 0);
+        }
+
+        return span;
 }
 
 /******** UArray2_map_col_major ********
@@ -188,7 +541,7 @@ void *UArray2_at(T uarray2, int col, int row)
  * Return: 
  *      nothing
  * Expects:
- *      CRE if uarray2 is NULL (thrown by Hanson)
+ *      CRE if uarray2 is NULL
  *      CRE if passed NULL function pointer
  *      CRE if void pointer supplied is NULL
  * Notes:
@@ -201,12 +554,14 @@ void UArray2_map_col_major(T uarray2,
         assert(uarray2 != NULL && apply != NULL && cl != NULL);
         
         for (int col = 0; col < uarray2->width; col++) {
-                for (int row = 0; row < uarray2->height; row++) {
-                        apply(col, row, uarray2, UArray2_at(uarray2, col, row), 
-                                cl);
+                UArray2_span span = UArray2_col_span(uarray2, col);
+                char *cell = span.base;
+
+                for (int row = 0; row < span.count; row++) {
+                        apply(col, row, uarray2, cell, cl);
+                        cell += span.stride;
                 }
         }
-        
 }
 
 /******** UArray2_map_row_major ********
@@ -228,7 +583,7 @@ void UArray2_map_col_major(T uarray2,
  * Return:
  *      nothing
  * Expects:
- *      CRE if uarray2 is NULL (thrown by Hanson)
+ *      CRE if uarray2 is NULL
  *      CRE if passed NULL function pointer
  *      CRE if void pointer supplied is NULL
  * Notes:
@@ -241,11 +596,492 @@ void UArray2_map_row_major(T uarray2,
         assert(uarray2 != NULL && apply != NULL && cl != NULL);
         
         for (int row = 0; row < uarray2->height; row++) {
-                for (int col = 0; col < uarray2->width; col++) {
-                        apply(col, row, uarray2, UArray2_at(uarray2, col, row), 
-                                cl);
+                UArray2_span span = UArray2_row_span(uarray2, row);
+                char *cell = span.base;
+
+                for (int col = 0; col < span.count; col++) {
+                        apply(col, row, uarray2, cell, cl);
+                        cell += span.stride;
+                }
+        }
+}
+
+/******** UArray2_map_col_major_until ********
+ *
+ * Visit cells in column-major order until apply returns true
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      bool apply:     function applied to each cell; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      true if apply stopped the traversal early, false otherwise
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool UArray2_map_col_major_until(T uarray2,
+        bool apply(int col, int row, T a, void *p1, void *p2), void *cl)
+{
+        assert(uarray2 != NULL && apply != NULL);
+
+        for (int col = 0; col < uarray2->width; col++) {
+                UArray2_span span = UArray2_col_span(uarray2, col);
+                char *cell = span.base;
+
+                for (int row = 0; row < span.count; row++) {
+                        if (apply(col, row, uarray2, cell, cl)) {
+                                return true;
+                        }
+                        cell += span.stride;
                 }
         }
+
+        return false;
+}
+
+/******** UArray2_map_row_major_until ********
+ *
+ * Visit cells in row-major order until apply returns true
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      bool apply:     function applied to each cell; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      true if apply stopped the traversal early, false otherwise
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool UArray2_map_row_major_until(T uarray2,
+        bool apply(int col, int row, T a, void *p1, void *p2), void *cl)
+{
+        assert(uarray2 != NULL && apply != NULL);
+
+        for (int row = 0; row < uarray2->height; row++) {
+                UArray2_span span = UArray2_row_span(uarray2, row);
+                char *cell = span.base;
+
+                for (int col = 0; col < span.count; col++) {
+                        if (apply(col, row, uarray2, cell, cl)) {
+                                return true;
+                        }
+                        cell += span.stride;
+                }
+        }
+
+        return false;
+}
+
+/******** UArray2_map_row_spans ********
+ *
+ * Visit the array one row at a time, handing apply a span of the whole row
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      void apply:     function applied to each row, given the row index,
+ *                      a span of the row's cells, the array, and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2_map_row_spans(T uarray2,
+        void apply(int row, UArray2_span span, T a, void *cl), void *cl)
+{
+        assert(uarray2 != NULL && apply != NULL);
+
+        for (int row = 0; row < uarray2->height; row++) {
+                apply(row, UArray2_row_span(uarray2, row), uarray2, cl);
+        }
+}
+
+/******** UArray2_map_col_spans ********
+ *
+ * Visit the array one column at a time, handing apply a strided span of the
+ * whole column
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      void apply:     function applied to each column, given the column
+ *                      index, a span of the column's cells, the array, and
+ *                      the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2_map_col_spans(T uarray2,
+        void apply(int col, UArray2_span span, T a, void *cl), void *cl)
+{
+        assert(uarray2 != NULL && apply != NULL);
+
+        for (int col = 0; col < uarray2->width; col++) {
+                apply(col, UArray2_col_span(uarray2, col), uarray2, cl);
+        }
+}
+
+/******** UArray2_map_row_major_parallel ********
+ *
+ * Visit each cell like UArray2_map_row_major, but split the rows into
+ * nthreads contiguous bands and map each band on its own thread.
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      int nthreads:   number of worker threads, or <= 0 to use one thread
+ *                      per online processor
+ *      void apply:     function applied to each cell, called with the
+ *                      worker's own closure
+ *      void *init:     makes a fresh closure for one worker from cl, or NULL
+ *      void merge:     folds one worker's closure back into cl, or NULL
+ *      void *cl:       the client's closure
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL
+ *      init and merge are both NULL or both not NULL
+ *      CRE otherwise, or if a thread cannot be created
+ * Notes:
+ *      See parallel_map
+ ************************/
+void UArray2_map_row_major_parallel(T uarray2, int nthreads,
+        void apply(int col, int row, T a, void *p1, void *p2),
+        void *init(void *cl), void merge(void *cl, void *local), void *cl)
+{
+        parallel_map(uarray2, nthreads, true, apply, init, merge, cl);
+}
+
+/******** UArray2_map_col_major_parallel ********
+ *
+ * Visit each cell like UArray2_map_col_major, but split the columns into
+ * nthreads contiguous bands and map each band on its own thread.
+ *
+ * Parameters:
+ *      same as UArray2_map_row_major_parallel
+ * Return:
+ *      nothing
+ * Expects:
+ *      same as UArray2_map_row_major_parallel
+ * Notes:
+ *      See parallel_map
+ ************************/
+void UArray2_map_col_major_parallel(T uarray2, int nthreads,
+        void apply(int col, int row, T a, void *p1, void *p2),
+        void *init(void *cl), void merge(void *cl, void *local), void *cl)
+{
+        parallel_map(uarray2, nthreads, false, apply, init, merge, cl);
+}
+
+/******** parallel_map ********
+ *
+ * Split the array into bands of rows (or columns), give each band a closure
+ * from init, map the bands on separate threads, then merge the closures.
+ *
+ * Parameters:
+ *      T uarray2:      array to map over
+ *      int nthreads:   requested worker count, <= 0 for one per processor
+ *      bool by_row:    true for row bands, false for column bands
+ *      apply, init, merge, cl: as in UArray2_map_row_major_parallel
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL
+ *      init and merge are both NULL or both not NULL
+ *      CRE otherwise
+ * Notes:
+ *      The calling thread maps the first band itself, so a single-band map
+ *      never creates a thread. Bands never outnumber rows (or columns).
+ ************************/
+static void parallel_map(T uarray2, int nthreads, bool by_row,
+        void apply(int col, int row, T a, void *p1, void *p2),
+        void *init(void *cl), void merge(void *cl, void *local), void *cl)
+{
+        assert(uarray2 != NULL && apply != NULL);
+        assert((init == NULL) == (merge == NULL));
+
+        int extent = by_row ? uarray2->height : uarray2->width;
+        void *(*map_band)(void *) = by_row ? map_row_band : map_col_band;
+
+        if (nthreads <= 0) {
+                nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if (nthreads > extent) {
+                nthreads = extent;
+        }
+        if (nthreads < 1) {
+                return;
+        }
+
+        Band *bands = malloc(nthreads * sizeof(*bands));
+        assert(bands != NULL);
+
+        /* Hand out bands and closures on this thread, in order */
+        for (int i = 0; i < nthreads; i++) {
+                bands[i].uarray2 = uarray2;
+                bands[i].first = (int) ((long) extent * i / nthreads);
+                bands[i].last = (int) ((long) extent * (i + 1) / nthreads);
+                bands[i].apply = apply;
+                bands[i].cl = init != NULL ? init(cl) : cl;
+        }
+
+        for (int i = 1; i < nthreads; i++) {
+                int err = pthread_create(&bands[i].thread, NULL, map_band,
+                                         &bands[i]);
+                assert(err == 0);
+        }
+        map_band(&bands[0]);
+
+        /* Join in band order so merges are deterministic */
+        for (int i = 0; i < nthreads; i++) {
+                if (i > 0) {
+                        pthread_join(bands[i].thread, NULL);
+                }
+                if (merge != NULL) {
+                        merge(cl, bands[i].cl);
+                }
+        }
+
+        free(bands);
+}
+
+/******** map_row_band ********
+ *
+ * Thread body: visit rows [first, last) of a band in row-major order
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL
+ * Expects:
+ *      band_vp is not NULL
+ * Notes:
+ *      none
+ ************************/
+static void *map_row_band(void *band_vp)
+{
+        Band *band = band_vp;
+
+        for (int row = band->first; row < band->last; row++) {
+                UArray2_span span = UArray2_row_span(band->uarray2, row);
+                char *cell = span.base;
+
+                for (int col = 0; col < span.count; col++) {
+                        band->apply(col, row, band->uarray2, cell, band->cl);
+                        cell += span.stride;
+                }
+        }
+
+        return NULL;
+}
+
+/******** map_col_band ********
+ *
+ * Thread body: visit columns [first, last) of a band in column-major order
+ *
+ * Parameters:
+ *      void *band_vp:  pointer to this worker's Band
+ * Return:
+ *      NULL
+ * Expects:
+ *      band_vp is not NULL
+ * Notes:
+ *      none
+ ************************/
+static void *map_col_band(void *band_vp)
+{
+        Band *band = band_vp;
+
+        for (int col = band->first; col < band->last; col++) {
+                UArray2_span span = UArray2_col_span(band->uarray2, col);
+                char *cell = span.base;
+
+                for (int row = 0; row < span.count; row++) {
+                        band->apply(col, row, band->uarray2, cell, band->cl);
+                        cell += span.stride;
+                }
+        }
+
+        return NULL;
+}
+
+/******** UArray2_transpose ********
+ *
+ * Make a new array holding the transpose of uarray2
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ * Return:
+ *      a new height x width UArray2, owned by the client
+ * Expects:
+ *      uarray2 is not NULL. CRE otherwise.
+ * Notes:
+ *      See remap
+ ************************/
+T UArray2_transpose(T uarray2)
+{
+        return remap(uarray2, true, false, false);
+}
+
+/******** UArray2_rotate ********
+ *
+ * Make a new array holding uarray2 rotated clockwise
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      int degrees:    0, 90, 180, or 270
+ * Return:
+ *      a new UArray2, owned by the client
+ * Expects:
+ *      uarray2 is not NULL and degrees is one of the values above.
+ *      CRE otherwise.
+ * Notes:
+ *      90 is a transpose with mirrored columns, 270 a transpose with
+ *      mirrored rows, and 180 mirrors both without transposing.
+ ************************/
+T UArray2_rotate(T uarray2, int degrees)
+{
+        assert(degrees == 0 || degrees == 90 || degrees == 180 ||
+               degrees == 270);
+
+        switch (degrees) {
+        case 90:
+                return remap(uarray2, true, true, false);
+        case 180:
+                return remap(uarray2, false, true, true);
+        case 270:
+                return remap(uarray2, true, false, true);
+        default:
+                return remap(uarray2, false, false, false);
+        }
+}
+
+/******** UArray2_flip_horizontal ********
+ *
+ * Make a new array holding uarray2 mirrored left to right
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ * Return:
+ *      a new UArray2 of the same dimensions, owned by the client
+ * Expects:
+ *      uarray2 is not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+T UArray2_flip_horizontal(T uarray2)
+{
+        return remap(uarray2, false, true, false);
+}
+
+/******** UArray2_flip_vertical ********
+ *
+ * Make a new array holding uarray2 mirrored top to bottom
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ * Return:
+ *      a new UArray2 of the same dimensions, owned by the client
+ * Expects:
+ *      uarray2 is not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+T UArray2_flip_vertical(T uarray2)
+{
+        return remap(uarray2, false, false, true);
+}
+
+/******** remap ********
+ *
+ * Copy every cell of src into a new array, optionally transposing and then
+ * mirroring the columns and/or rows of the result
+ *
+ * Parameters:
+ *      T src:                  array to copy
+ *      bool swap:              true to transpose (result is height x width)
+ *      bool mirror_cols:       true to mirror the result left to right
+ *      bool mirror_rows:       true to mirror the result top to bottom
+ * Return:
+ *      the new array
+ * Expects:
+ *      src is not NULL. CRE otherwise.
+ * Notes:
+ *      Every transform is affine, so the destination of source cell
+ *      (col, row) is first + col * col_step + row * row_step bytes into the
+ *      result for fixed (signed) steps. Source cells are walked in square
+ *      tiles of about TILE_BYTES so the scattered writes of a transpose
+ *      land in a small set of destination rows that stays in cache.
+ ************************/
+static T remap(T src, bool swap, bool mirror_cols, bool mirror_rows)
+{
+        assert(src != NULL);
+
+        int width = src->width;
+        int height = src->height;
+        int size = src->size;
+        T dst = swap ? UArray2_new(height, width, size)
+                     : UArray2_new(width, height, size);
+
+        if (width == 0 || height == 0) {
+                return dst;
+        }
+
+        ptrdiff_t dstride = (ptrdiff_t) UArray2_stride(dst);
+        ptrdiff_t col_step = swap ? dstride : size;
+        ptrdiff_t row_step = swap ? size : dstride;
+        char *first = dst->elems;
+
+        /* Mirroring a result axis reverses the step feeding it */
+        if (mirror_cols) {
+                ptrdiff_t *step = swap ? &row_step : &col_step;
+                first += (ptrdiff_t) ((swap ? height : width) - 1) * size;
+                *step = -*step;
+        }
+        if (mirror_rows) {
+                ptrdiff_t *step = swap ? &col_step : &row_step;
+                first += (ptrdiff_t) ((swap ? width : height) - 1) * dstride;
+                *step = -*step;
+        }
+
+        /* In size_t, since a huge cell would overflow an int product */
+        int tile = 1;
+        while ((size_t) (tile * 2) * (tile * 2) * (size_t) size <=
+               TILE_BYTES) {
+                tile *= 2;
+        }
+
+        for (int top = 0; top < height; top += tile) {
+                int bottom = height - top > tile ? top + tile : height;
+
+                for (int left = 0; left < width; left += tile) {
+                        int right = width - left > tile ? left + tile : width;
+
+                        for (int row = top; row < bottom; row++) {
+                                char *from = UArray2_at(src, left, row);
+                                char *to = first + left * col_step +
+                                           row * row_step;
+
+                                for (int col = left; col < right; col++) {
+                                        memcpy(to, from, size);
+                                        from += size;
+                                        to += col_step;
+                                }
+                        }
+                }
+        }
+
+        return dst;
 }
 
-#undef T
\ No newline at end of file
+#undef T
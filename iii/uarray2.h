@@ -11,7 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include "uarray.h"
+#include "arena.h"
 
 #ifndef UARRAY2_INCLUDED
 #define UARRAY2_INCLUDED
@@ -20,6 +20,16 @@
 
 typedef struct T *T;
 
+/*
+ * A run of cells within a UArray2. Cell i of the run lives at
+ * (char *)base + i * stride, for i in [0, count).
+ */
+typedef struct UArray2_span {
+        void *base;
+        int count;
+        size_t stride;
+} UArray2_span;
+
 /******** UArray2_new ********
  *
  * Allocates space for a UArray2 if width and height are non-negative and size
@@ -37,9 +47,83 @@ typedef struct T *T;
  *      throws a CRE if an invalid input is given
  * Notes:
  *      throws a CRE if malloc fails
+ *      The header and the cells share one allocation, so a grid costs a
+ *      single malloc and its metadata sits next to its data.
+ *      width * height * size is computed in size_t, so grids may hold more
+ *      than 2^31 cells; throws a CRE if the total does not fit.
  ************************/
 T UArray2_new(int width, int height, int size);
 
+/******** UArray2_new_in ********
+ *
+ * Allocates a UArray2 like UArray2_new, but takes its single block of memory
+ * from a client-supplied Hanson arena instead of malloc. Batch jobs that
+ * make and drop many grids can recycle them all at once with Arena_free.
+ *
+ * Parameters:
+ *      int width: the width of the array to be created
+ *      int height: the height of the array to be created
+ *      int size: the number of bytes per cell in the array
+ *      Arena_T arena: the arena that owns the array's memory
+ * Return: 
+ *      a struct pointer to the instance of the new UArray
+ * Expects:
+ *      width and height are nonnegative
+ *      size is positive
+ *      arena is not NULL
+ *      throws a CRE if an invalid input is given
+ * Notes:
+ *      Arena_calloc raises Arena_Failed if it runs out of memory
+ ************************/
+T UArray2_new_in(int width, int height, int size, Arena_T arena);
+
+/******** UArray2_new_mapped ********
+ *
+ * Allocates a UArray2 whose cells live in a memory-mapped file rather than on
+ * the heap, for grids too large to hold comfortably in memory. The file is
+ * created (or truncated) and laid out as described in mapfile.h, with the
+ * cells stored row-major as the payload.
+ *
+ * Parameters:
+ *      const char *path: file to hold the cells
+ *      int width: the width of the array to be created
+ *      int height: the height of the array to be created
+ *      int size: the number of bytes per cell in the array
+ * Return: 
+ *      a struct pointer to the instance of the new UArray
+ * Expects:
+ *      path is not NULL
+ *      width and height are nonnegative
+ *      size is positive
+ *      throws a CRE if an invalid input is given or the file cannot be
+ *      created and mapped
+ * Notes:
+ *      All cells start out zero. The mapping is shared, so other processes
+ *      that map the same file see the same cells through the page cache.
+ ************************/
+T UArray2_new_mapped(const char *path, int width, int height, int size);
+
+/******** UArray2_open_mapped ********
+ *
+ * Maps an existing grid file made by UArray2_new_mapped. If writable,
+ * changes to the cells are written back to the file.
+ *
+ * Parameters:
+ *      const char *path: grid file to open
+ *      bool writable: whether changes should reach the file
+ * Return: 
+ *      a struct pointer to a UArray2 over the file's cells
+ * Expects:
+ *      path is not NULL
+ *      throws a CRE if the file cannot be mapped or is not a UArray2 grid
+ *      file of a consistent length
+ * Notes:
+ *      Nothing is read up front; pages are faulted in as cells are touched.
+ *      A file opened with writable false only needs read permission; the
+ *      array can still be changed, but only in this process's copy.
+ ************************/
+T UArray2_open_mapped(const char *path, bool writable);
+
 /******** UArray2_free ********
  *
  * Recycle memory of a UArray2
@@ -47,12 +131,13 @@ T UArray2_new(int width, int height, int size);
  * Parameters:
  *      *uarray2: pointer value of uarray object
  * Return: 
- *      Nothing, but Hanson's UArray_free will signal that uarray2 points to
- *      freed memory at end of successful function call
+ *      Nothing, *uarray2 is set to NULL
  * Expects:
- *      CRE if uarray2 or *uarray2 are NULL (plan to check if thrown by Hanson)
+ *      CRE if uarray2 or *uarray2 are NULL
  * Notes:
- *      None
+ *      An array made by UArray2_new_in is owned by its arena, so its memory
+ *      is only recycled when the client calls Arena_free or Arena_dispose.
+ *      A mapped array is unmapped; its cells stay in the file.
  ************************/
 void UArray2_free(T *uarray2);
 
@@ -105,8 +190,8 @@ int UArray2_size(T uarray2);
 
 /******** UArray2_at ********
  *
- * Client requests UArray2_at(col, row). Under the hood, we are actually going
- * for 1D Uarray which can be accessed at UArray_at(row * width + col).
+ * Client requests UArray2_at(col, row). Under the hood, the cells are one
+ * row-major block, so the cell is at offset (row * width + col) * size.
  *
  * Parameters:
  *      uarray2: address value of uarray object
@@ -115,13 +200,86 @@ int UArray2_size(T uarray2);
  * Return: 
  *      void pointer to value stored at (col, row) 2D or (row * width + col) 1D
  * Expects:
- *      CRE if uarray2 is NULL (thrown by Hanson)
+ *      CRE if uarray2 is NULL
  *      col and row are within [0, width - 1] and [0, height - 1] respectively
  * Notes:
  *      none
  ************************/
  void *UArray2_at(T uarray2, int col, int row);
  
+/******** UArray2_row ********
+ *
+ * Return a pointer to the first cell of a row. The cells of a row are
+ * contiguous, so cell (col, row) lives at (char *)base + col * size, and the
+ * next row starts UArray2_stride() bytes further on.
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ *      int row: the row requested
+ * Return:
+ *      void pointer to cell (0, row), or NULL if the array has no columns
+ * Expects:
+ *      uarray2 is not NULL
+ *      row is within [0, height - 1]
+ *      CRE otherwise
+ * Notes:
+ *      Bounds are checked once here rather than once per cell, so hot loops
+ *      can walk the row with plain pointer arithmetic.
+ ************************/
+void *UArray2_row(T uarray2, int row);
+
+/******** UArray2_stride ********
+ *
+ * Return the number of bytes between the start of one row and the next
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ * Return:
+ *      width * size
+ * Expects:
+ *      uarray2 is not NULL
+ *      CRE if uarray2 is NULL
+ * Notes:
+ *      none
+ ************************/
+size_t UArray2_stride(T uarray2);
+
+/******** UArray2_row_span ********
+ *
+ * Return a span covering every cell of one row
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ *      int row: the row requested
+ * Return:
+ *      span with count == width and stride == size
+ * Expects:
+ *      uarray2 is not NULL
+ *      row is within [0, height - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2_row_span(T uarray2, int row);
+
+/******** UArray2_col_span ********
+ *
+ * Return a span covering every cell of one column
+ *
+ * Parameters:
+ *      uarray2: address value of uarray object
+ *      int col: the column requested
+ * Return:
+ *      span with count == height and stride == UArray2_stride(uarray2)
+ * Expects:
+ *      uarray2 is not NULL
+ *      col is within [0, width - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2_col_span(T uarray2, int col);
+
 /******** UArray2_map_col_major ********
  *
  * Visit each cell in array via column major order and map according to some 
@@ -143,7 +301,7 @@ int UArray2_size(T uarray2);
  * Return: 
  *      nothing
  * Expects:
- *      CRE if uarray2 is NULL (thrown by Hanson)
+ *      CRE if uarray2 is NULL
  *      CRE if passed NULL function pointer
  *      CRE if void pointer supplied is NULL
  * Notes:
@@ -171,7 +329,7 @@ void UArray2_map_col_major(T uarray2,
  * Return:
  *      nothing
  * Expects:
- *      CRE if uarray2 is NULL (thrown by Hanson)
+ *      CRE if uarray2 is NULL
  *      CRE if passed NULL function pointer
  *      CRE if void pointer supplied is NULL
  * Notes:
@@ -180,5 +338,211 @@ void UArray2_map_col_major(T uarray2,
 void UArray2_map_row_major(T uarray2, 
         void apply(int col, int row, T a, void *p1, void *p2), void *cl);
 
+/******** UArray2_map_col_major_until ********
+ *
+ * Visit cells in the same order as UArray2_map_col_major, but stop as soon as
+ * apply returns true. Validators use this to quit on the first failure
+ * instead of visiting every remaining cell.
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      bool apply:     function applied to each cell; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      true if apply stopped the traversal early, false if every cell was
+ *      visited
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool UArray2_map_col_major_until(T uarray2,
+        bool apply(int col, int row, T a, void *p1, void *p2), void *cl);
+
+/******** UArray2_map_row_major_until ********
+ *
+ * Visit cells in the same order as UArray2_map_row_major, but stop as soon as
+ * apply returns true.
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      bool apply:     function applied to each cell; returns true to stop
+ *                      the traversal, false to keep going
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      true if apply stopped the traversal early, false if every cell was
+ *      visited
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool UArray2_map_row_major_until(T uarray2,
+        bool apply(int col, int row, T a, void *p1, void *p2), void *cl);
+
+/******** UArray2_map_row_spans ********
+ *
+ * Visit the array one row at a time. apply is called once per row with a span
+ * covering the whole row, so the client loops over the cells itself instead
+ * of paying for a function call per cell.
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      void apply:     function applied to each row, given the row index,
+ *                      a span of the row's cells, the array, and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      Row spans are contiguous (stride == size), so a loop over
+ *      span.count cells from span.base can be vectorized.
+ ************************/
+void UArray2_map_row_spans(T uarray2,
+        void apply(int row, UArray2_span span, T a, void *cl), void *cl);
+
+/******** UArray2_map_col_spans ********
+ *
+ * Visit the array one column at a time. apply is called once per column with
+ * a strided span covering the whole column.
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      void apply:     function applied to each column, given the column
+ *                      index, a span of the column's cells, the array, and
+ *                      the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2_map_col_spans(T uarray2,
+        void apply(int col, UArray2_span span, T a, void *cl), void *cl);
+
+/******** UArray2_map_row_major_parallel ********
+ *
+ * Visit each cell like UArray2_map_row_major, but split the rows into
+ * nthreads contiguous bands and map each band on its own thread. Cells within
+ * a band are visited in row-major order; bands run concurrently.
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      int nthreads:   number of worker threads, or <= 0 to use one thread
+ *                      per online processor
+ *      void apply:     function applied to each cell, called with the
+ *                      worker's own closure
+ *      void *init:     makes a fresh closure for one worker from cl. May be
+ *                      NULL, in which case every worker shares cl and apply
+ *                      must be safe to run concurrently.
+ *      void merge:     folds one worker's closure back into cl and recycles
+ *                      it. May be NULL only if init is NULL.
+ *      void *cl:       the client's closure
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2 and apply are not NULL
+ *      init and merge are both NULL or both not NULL
+ *      CRE otherwise, or if a thread cannot be created
+ * Notes:
+ *      init and merge are only ever called from the calling thread, one
+ *      worker at a time and in band order, so they need no locking and
+ *      reductions come out the same on every run.
+ ************************/
+void UArray2_map_row_major_parallel(T uarray2, int nthreads,
+        void apply(int col, int row, T a, void *p1, void *p2),
+        void *init(void *cl), void merge(void *cl, void *local), void *cl);
+
+/******** UArray2_map_col_major_parallel ********
+ *
+ * Visit each cell like UArray2_map_col_major, but split the columns into
+ * nthreads contiguous bands and map each band on its own thread. Cells within
+ * a band are visited in column-major order; bands run concurrently.
+ *
+ * Parameters:
+ *      same as UArray2_map_row_major_parallel
+ * Return:
+ *      nothing
+ * Expects:
+ *      same as UArray2_map_row_major_parallel
+ * Notes:
+ *      same as UArray2_map_row_major_parallel
+ ************************/
+void UArray2_map_col_major_parallel(T uarray2, int nthreads,
+        void apply(int col, int row, T a, void *p1, void *p2),
+        void *init(void *cl), void merge(void *cl, void *local), void *cl);
+
+/******** UArray2_transpose ********
+ *
+ * Make a new array holding the transpose: cell (col, row) of the original is
+ * cell (row, col) of the result
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ * Return:
+ *      a new height x width UArray2, owned by the client
+ * Expects:
+ *      uarray2 is not NULL. CRE otherwise.
+ * Notes:
+ *      Cells are copied in square tiles sized to stay in cache, so neither
+ *      the reads nor the writes stride through the whole array per cell.
+ *      A column-major pass over a large array can instead be a transpose
+ *      followed by a row-major pass.
+ ************************/
+T UArray2_transpose(T uarray2);
+
+/******** UArray2_rotate ********
+ *
+ * Make a new array holding the original rotated clockwise
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ *      int degrees:    0, 90, 180, or 270
+ * Return:
+ *      a new UArray2, owned by the client (height x width for 90 and 270)
+ * Expects:
+ *      uarray2 is not NULL and degrees is one of the values above.
+ *      CRE otherwise.
+ * Notes:
+ *      Copies in cache-sized tiles like UArray2_transpose
+ ************************/
+T UArray2_rotate(T uarray2, int degrees);
+
+/******** UArray2_flip_horizontal ********
+ *
+ * Make a new array holding the original mirrored left to right: cell
+ * (col, row) moves to (width - 1 - col, row)
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ * Return:
+ *      a new UArray2 of the same dimensions, owned by the client
+ * Expects:
+ *      uarray2 is not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+T UArray2_flip_horizontal(T uarray2);
+
+/******** UArray2_flip_vertical ********
+ *
+ * Make a new array holding the original mirrored top to bottom: cell
+ * (col, row) moves to (col, height - 1 - row)
+ *
+ * Parameters:
+ *      uarray2:        address value of uarray object
+ * Return:
+ *      a new UArray2 of the same dimensions, owned by the client
+ * Expects:
+ *      uarray2 is not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+T UArray2_flip_vertical(T uarray2);
+
 #undef T
-#endif
\ No newline at end of file
+#endif
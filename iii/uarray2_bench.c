@@ -0,0 +1,213 @@
+/*
+ *      uarray2_bench.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Benchmark comparing the serial UArray2 maps against the parallel maps
+ *      on a large grid of ints. Each map sums every cell.
+ *
+ *      Usage: uarray2_bench [width height [nthreads]]
+ *      Defaults to a 10000 x 10000 grid (10^8 cells) and one thread per
+ *      online processor.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include "uarray2.h"
+#include "assert.h"
+
+typedef struct sum {
+        long total;
+} Sum;
+
+void fill(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
+void add(int col, int row, UArray2_T uarray2, void *val_vp, void *cl);
+void *new_sum(void *cl);
+void merge_sum(void *cl, void *local);
+double seconds_since(struct timespec start);
+
+/******** main ********
+ *
+ * Time each map over the same grid and print the results
+ *
+ * Parameters:
+ *      int argc:       argument count
+ *      char *argv[]:   optional width, height, and thread count
+ * Return:
+ *      0 if every map produced the same sum
+ * Expects:
+ *      argc is 1, 3, or 4. Throws CRE otherwise.
+ * Notes:
+ *      None
+ ************************/
+int main(int argc, char *argv[])
+{
+        assert(argc == 1 || argc == 3 || argc == 4);
+
+        int width = argc > 1 ? atoi(argv[1]) : 10000;
+        int height = argc > 1 ? atoi(argv[2]) : 10000;
+        int nthreads = argc > 3 ? atoi(argv[3]) : 0;
+
+        UArray2_T grid = UArray2_new(width, height, sizeof(int));
+        Sum sums[4] = { { 0 }, { 0 }, { 0 }, { 0 } };
+        double times[4];
+        struct timespec start;
+
+        UArray2_map_row_major_parallel(grid, nthreads, fill, NULL, NULL,
+                                       NULL);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        UArray2_map_row_major(grid, add, &sums[0]);
+        times[0] = seconds_since(start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        UArray2_map_col_major(grid, add, &sums[1]);
+        times[1] = seconds_since(start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        UArray2_map_row_major_parallel(grid, nthreads, add, new_sum,
+                                       merge_sum, &sums[2]);
+        times[2] = seconds_since(start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        UArray2_map_col_major_parallel(grid, nthreads, add, new_sum,
+                                       merge_sum, &sums[3]);
+        times[3] = seconds_since(start);
+
+        printf("%d x %d cells, %d threads requested\n", width, height,
+               nthreads);
+        printf("serial row major:    %8.3f s  (sum %ld)\n", times[0],
+               sums[0].total);
+        printf("serial col major:    %8.3f s  (sum %ld)\n", times[1],
+               sums[1].total);
+        printf("parallel row major:  %8.3f s  (sum %ld)\n", times[2],
+               sums[2].total);
+        printf("parallel col major:  %8.3f s  (sum %ld)\n", times[3],
+               sums[3].total);
+
+        UArray2_free(&grid);
+
+        for (int i = 1; i < 4; i++) {
+                if (sums[i].total != sums[0].total) {
+                        return EXIT_FAILURE;
+                }
+        }
+
+        return 0;
+}
+
+/******** fill ********
+ *
+ * Store a small value derived from the cell's coordinates
+ *
+ * Parameters:
+ *      int col, int row:       coordinates of the cell
+ *      UArray2_T uarray2:      unused
+ *      void *val_vp:           pointer to the cell
+ *      void *cl:               unused
+ * Return:
+ *      none
+ * Expects:
+ *      val_vp is not NULL
+ * Notes:
+ *      Safe to run concurrently since each call writes only its own cell
+ ************************/
+void fill(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
+{
+        (void) uarray2;
+        (void) cl;
+
+        *(int *)val_vp = (col ^ row) & 0xff;
+}
+
+/******** add ********
+ *
+ * Add a cell's value into a running sum
+ *
+ * Parameters:
+ *      int col, int row:       unused
+ *      UArray2_T uarray2:      unused
+ *      void *val_vp:           pointer to the cell
+ *      void *cl:               pointer to a Sum
+ * Return:
+ *      none
+ * Expects:
+ *      val_vp and cl are not NULL
+ * Notes:
+ *      none
+ ************************/
+void add(int col, int row, UArray2_T uarray2, void *val_vp, void *cl)
+{
+        (void) col;
+        (void) row;
+        (void) uarray2;
+
+        ((Sum *)cl)->total += *(int *)val_vp;
+}
+
+/******** new_sum ********
+ *
+ * Make a zeroed Sum for one worker
+ *
+ * Parameters:
+ *      void *cl:       the shared Sum (unused)
+ * Return:
+ *      pointer to a new Sum
+ * Expects:
+ *      none
+ * Notes:
+ *      Recycled by merge_sum
+ ************************/
+void *new_sum(void *cl)
+{
+        (void) cl;
+
+        Sum *local = calloc(1, sizeof(*local));
+        assert(local != NULL);
+
+        return local;
+}
+
+/******** merge_sum ********
+ *
+ * Fold one worker's Sum into the shared Sum and recycle it
+ *
+ * Parameters:
+ *      void *cl:       the shared Sum
+ *      void *local:    the worker's Sum
+ * Return:
+ *      none
+ * Expects:
+ *      cl and local are not NULL
+ * Notes:
+ *      none
+ ************************/
+void merge_sum(void *cl, void *local)
+{
+        ((Sum *)cl)->total += ((Sum *)local)->total;
+        free(local);
+}
+
+/******** seconds_since ********
+ *
+ * Return the wall-clock seconds elapsed since start
+ *
+ * Parameters:
+ *      struct timespec start:  time the measurement began
+ * Return:
+ *      elapsed seconds
+ * Expects:
+ *      none
+ * Notes:
+ *      none
+ ************************/
+double seconds_since(struct timespec start)
+{
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        return (end.tv_sec - start.tv_sec) +
+               (end.tv_nsec - start.tv_nsec) / 1e9;
+}
@@ -0,0 +1,295 @@
+/*
+ *      uarray2b.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of blocked two-dimensional arrays. All blocks live in
+ *      one Hanson UArray, one block after another, so a block is a single
+ *      contiguous run of blocksize * blocksize cells.
+ */
+
+#include <limits.h>
+#include <math.h>
+#include "uarray2b.h"
+#include "assert.h"
+
+#define T UArray2b_T
+
+/* Number of bytes one block may occupy for UArray2b_new_64K_block */
+#define BLOCK_BYTES (64 * 1024)
+
+struct T
+{
+        int width;
+        int height;
+        int size;
+        int blocksize;
+        int blocks_wide;
+        UArray_T blocks;
+};
+
+/******** UArray2b_new ********
+ *
+ * Allocates space for a blocked 2D array whose cells are grouped into square
+ * blocks of blocksize * blocksize cells.
+ *
+ * Parameters:
+ *      int width:      the width of the array to be created
+ *      int height:     the height of the array to be created
+ *      int size:       the number of bytes per cell in the array
+ *      int blocksize:  the number of cells along one side of a block
+ * Return:
+ *      a struct pointer to the instance of the new UArray2b
+ * Expects:
+ *      width and height are nonnegative
+ *      size and blocksize are positive
+ *      throws a CRE if an invalid input is given
+ * Notes:
+ *      throws a CRE if malloc fails, or if the padded grid holds more than
+ *      INT_MAX cells
+ ************************/
+T UArray2b_new(int width, int height, int size, int blocksize)
+{
+        assert(0 <= width && 0 <= height && 0 < size && 0 < blocksize);
+
+        /* Round partial blocks up so every cell has a home */
+        int blocks_wide = width / blocksize + (width % blocksize != 0);
+        int blocks_high = height / blocksize + (height % blocksize != 0);
+
+        /* Hanson's UArray is indexed by int, so the padded total must fit */
+        size_t cells = (size_t) blocks_wide * blocks_high * blocksize *
+                       blocksize;
+        assert(cells <= INT_MAX);
+
+        T arr2b = malloc(sizeof(*arr2b));
+        assert(arr2b != NULL);
+
+        arr2b->width = width;
+        arr2b->height = height;
+        arr2b->size = size;
+        arr2b->blocksize = blocksize;
+        arr2b->blocks_wide = blocks_wide;
+        arr2b->blocks = UArray_new((int) cells, size);
+
+        return arr2b;
+}
+
+/******** UArray2b_new_64K_block ********
+ *
+ * Allocates space for a blocked 2D array with the largest blocksize such that
+ * one block fits in 64KB.
+ *
+ * Parameters:
+ *      int width:      the width of the array to be created
+ *      int height:     the height of the array to be created
+ *      int size:       the number of bytes per cell in the array
+ * Return:
+ *      a struct pointer to the instance of the new UArray2b
+ * Expects:
+ *      width and height are nonnegative
+ *      size is positive
+ *      throws a CRE if an invalid input is given
+ * Notes:
+ *      If a single cell is larger than 64KB, the blocksize is 1.
+ ************************/
+T UArray2b_new_64K_block(int width, int height, int size)
+{
+        assert(0 < size);
+
+        int blocksize = (int) sqrt((double) BLOCK_BYTES / size);
+        if (blocksize < 1) {
+                blocksize = 1;
+        }
+
+        return UArray2b_new(width, height, size, blocksize);
+}
+
+/******** UArray2b_free ********
+ *
+ * Recycle memory of a UArray2b
+ *
+ * Parameters:
+ *      T *uarray2b:    pointer to the UArray2b to free
+ * Return:
+ *      Nothing, *uarray2b is set to NULL
+ * Expects:
+ *      uarray2b and *uarray2b are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      None
+ ************************/
+void UArray2b_free(T *uarray2b)
+{
+        assert(uarray2b != NULL && *uarray2b != NULL);
+
+        UArray_free(&(*uarray2b)->blocks);
+        free(*uarray2b);
+        *uarray2b = NULL;
+}
+
+/******** UArray2b_width ********
+ *
+ * Return the number of columns of a UArray2b
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      int representing the number of columns
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_width(T uarray2b)
+{
+        assert(uarray2b != NULL);
+
+        return uarray2b->width;
+}
+
+/******** UArray2b_height ********
+ *
+ * Return the number of rows of a UArray2b
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      int representing the number of rows
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_height(T uarray2b)
+{
+        assert(uarray2b != NULL);
+
+        return uarray2b->height;
+}
+
+/******** UArray2b_size ********
+ *
+ * Return the number of bytes per unboxed slot
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      the number of bytes per unboxed slot
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_size(T uarray2b)
+{
+        assert(uarray2b != NULL);
+
+        return uarray2b->size;
+}
+
+/******** UArray2b_blocksize ********
+ *
+ * Return the number of cells along one side of a block
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      the blocksize given (or computed) at creation
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_blocksize(T uarray2b)
+{
+        assert(uarray2b != NULL);
+
+        return uarray2b->blocksize;
+}
+
+/******** UArray2b_at ********
+ *
+ * Client requests UArray2b_at(col, row). Under the hood, the cell lives in
+ * block (col / blocksize, row / blocksize) at offset
+ * (row % blocksize) * blocksize + (col % blocksize) within that block.
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ *      int col:        the col of the requested cell
+ *      int row:        the row of the requested cell
+ * Return:
+ *      void pointer to the value stored at (col, row)
+ * Expects:
+ *      uarray2b is not NULL
+ *      col and row are within [0, width - 1] and [0, height - 1] respectively
+ *      throws CRE otherwise
+ * Notes:
+ *      none
+ ************************/
+void *UArray2b_at(T uarray2b, int col, int row)
+{
+        assert(uarray2b != NULL && 0 <= col && col < uarray2b->width &&
+                0 <= row && row < uarray2b->height);
+
+        int bs = uarray2b->blocksize;
+        int block = (row / bs) * uarray2b->blocks_wide + col / bs;
+
+        return UArray_at(uarray2b->blocks, block * bs * bs + (row % bs) * bs +
+                         col % bs);
+}
+
+/******** UArray2b_map_block_major ********
+ *
+ * Visit each cell in block-major order: every cell of one block is visited
+ * (row-major within the block) before moving onto the next block, and blocks
+ * themselves are visited row-major.
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ *      void apply:     function applied to each cell, given its column, row,
+ *                      the array, a pointer to the cell, and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2b and apply are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Each block is found with one UArray_at; cells inside it are reached
+ *      by pointer arithmetic since a block is contiguous. Padding cells in
+ *      partial edge blocks are skipped.
+ ************************/
+void UArray2b_map_block_major(T uarray2b,
+        void apply(int col, int row, T a, void *elem, void *cl), void *cl)
+{
+        assert(uarray2b != NULL && apply != NULL);
+
+        int bs = uarray2b->blocksize;
+        int size = uarray2b->size;
+        size_t stride = (size_t) bs * size;
+        int height = uarray2b->height;
+        int width = uarray2b->width;
+        int block = 0;
+        int bottom;
+        int right;
+
+        /* Edges are clamped before adding, so a huge bs cannot overflow */
+        for (int top = 0; top < height; top = bottom) {
+                bottom = bs > height - top ? height : top + bs;
+                for (int left = 0; left < width; left = right) {
+                        char *base = UArray_at(uarray2b->blocks,
+                                               block * bs * bs);
+                        right = bs > width - left ? width : left + bs;
+
+                        for (int row = top; row < bottom; row++) {
+                                char *cell = base + (row - top) * stride;
+                                for (int col = left; col < right; col++) {
+                                        apply(col, row, uarray2b, cell, cl);
+                                        cell += size;
+                                }
+                        }
+                        block++;
+                }
+        }
+}
+
+#undef T
@@ -0,0 +1,188 @@
+/*
+ *      uarray2b.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Header file with function prototypes and function contracts for the
+ *      blocked UArray2b implementation. A UArray2b holds the same cells as a
+ *      UArray2, but stores them in square blocks so that cells which are close
+ *      in two dimensions are also close in memory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "uarray.h"
+
+#ifndef UARRAY2B_INCLUDED
+#define UARRAY2B_INCLUDED
+
+#define T UArray2b_T
+
+typedef struct T *T;
+
+/******** UArray2b_new ********
+ *
+ * Allocates space for a blocked 2D array whose cells are grouped into square
+ * blocks of blocksize * blocksize cells.
+ *
+ * Parameters:
+ *      int width:      the width of the array to be created
+ *      int height:     the height of the array to be created
+ *      int size:       the number of bytes per cell in the array
+ *      int blocksize:  the number of cells along one side of a block
+ * Return:
+ *      a struct pointer to the instance of the new UArray2b
+ * Expects:
+ *      width and height are nonnegative
+ *      size and blocksize are positive
+ *      throws a CRE if an invalid input is given
+ * Notes:
+ *      throws a CRE if malloc fails, or if the padded grid holds more than
+ *      INT_MAX cells
+ *      Blocks along the right and bottom edges are padded out to a full
+ *      block, so those padding cells are never visited by the map.
+ ************************/
+T UArray2b_new(int width, int height, int size, int blocksize);
+
+/******** UArray2b_new_64K_block ********
+ *
+ * Allocates space for a blocked 2D array with the largest blocksize such that
+ * one block fits in 64KB (a typical L1/L2 working set).
+ *
+ * Parameters:
+ *      int width:      the width of the array to be created
+ *      int height:     the height of the array to be created
+ *      int size:       the number of bytes per cell in the array
+ * Return:
+ *      a struct pointer to the instance of the new UArray2b
+ * Expects:
+ *      width and height are nonnegative
+ *      size is positive
+ *      throws a CRE if an invalid input is given
+ * Notes:
+ *      If a single cell is larger than 64KB, the blocksize is 1.
+ ************************/
+T UArray2b_new_64K_block(int width, int height, int size);
+
+/******** UArray2b_free ********
+ *
+ * Recycle memory of a UArray2b
+ *
+ * Parameters:
+ *      T *uarray2b:    pointer to the UArray2b to free
+ * Return:
+ *      Nothing, *uarray2b is set to NULL
+ * Expects:
+ *      uarray2b and *uarray2b are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      None
+ ************************/
+void UArray2b_free(T *uarray2b);
+
+/******** UArray2b_width ********
+ *
+ * Return the number of columns of a UArray2b
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      int representing the number of columns
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_width(T uarray2b);
+
+/******** UArray2b_height ********
+ *
+ * Return the number of rows of a UArray2b
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      int representing the number of rows
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_height(T uarray2b);
+
+/******** UArray2b_size ********
+ *
+ * Return the number of bytes per unboxed slot
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      the number of bytes per unboxed slot
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_size(T uarray2b);
+
+/******** UArray2b_blocksize ********
+ *
+ * Return the number of cells along one side of a block
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ * Return:
+ *      the blocksize given (or computed) at creation
+ * Expects:
+ *      uarray2b is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2b_blocksize(T uarray2b);
+
+/******** UArray2b_at ********
+ *
+ * Client requests UArray2b_at(col, row). Under the hood, the cell lives in
+ * block (col / blocksize, row / blocksize) at offset
+ * (row % blocksize) * blocksize + (col % blocksize) within that block.
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ *      int col:        the col of the requested cell
+ *      int row:        the row of the requested cell
+ * Return:
+ *      void pointer to the value stored at (col, row)
+ * Expects:
+ *      uarray2b is not NULL
+ *      col and row are within [0, width - 1] and [0, height - 1] respectively
+ *      throws CRE otherwise
+ * Notes:
+ *      none
+ ************************/
+void *UArray2b_at(T uarray2b, int col, int row);
+
+/******** UArray2b_map_block_major ********
+ *
+ * Visit each cell in block-major order: every cell of one block is visited
+ * (row-major within the block) before moving onto the next block, and blocks
+ * themselves are visited row-major. Consecutive calls touch consecutive
+ * memory, so neighbouring cells in both directions stay in cache.
+ *
+ * Parameters:
+ *      T uarray2b:     UArray2b instance
+ *      void apply:     function applied to each cell, given its column, row,
+ *                      the array, a pointer to the cell, and the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      uarray2b and apply are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Padding cells in partial edge blocks are skipped.
+ ************************/
+void UArray2b_map_block_major(T uarray2b,
+        void apply(int col, int row, T a, void *elem, void *cl), void *cl);
+
+#undef T
+#endif
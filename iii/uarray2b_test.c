@@ -0,0 +1,228 @@
+/*
+ *      uarray2b_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Test for the blocked UArray2b. Each array is filled through
+ *      UArray2b_at and then walked with UArray2b_map_block_major, which must
+ *      hand back the same cells, each exactly once, in block-major order.
+ *      Sizes cover whole and partial edge blocks, empty arrays, and
+ *      blocksizes far larger than the array.
+ *
+ *      Usage: uarray2b_test
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#include <limits.h>
+#include "uarray2b.h"
+#include "assert.h"
+
+/* What the map has seen so far, for checking the next cell it visits */
+typedef struct Visits {
+        int count;
+        int last_block;
+        int last_col;
+        int last_row;
+        bool ok;
+} Visits;
+
+bool check_array(int width, int height, int blocksize);
+bool check_64K_block(int width, int height, int size);
+void check_cell(int col, int row, UArray2b_T a, void *elem, void *cl);
+int block_of(UArray2b_T a, int col, int row);
+
+/******** main ********
+ *
+ * Run every test case and report the failures
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every case passed, EXIT_FAILURE otherwise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      The last cases have a blocksize near INT_MAX; they are only legal
+ *      when the array is empty in one dimension, since otherwise the
+ *      padded grid would not fit.
+ ************************/
+int main(void)
+{
+        static const int cases[][3] = {
+                { 1, 1, 1 },   { 5, 7, 1 },      { 8, 8, 4 },
+                { 9, 10, 4 },  { 10, 9, 3 },     { 3, 2, 16 },
+                { 33, 1, 5 },  { 1, 33, 5 },     { 0, 0, 3 },
+                { 0, 4, 2 },   { 4, 0, 2 },      { 0, 0, INT_MAX },
+                { 0, INT_MAX, INT_MAX / 2 + 1 }, { INT_MAX, 0, INT_MAX }
+        };
+        int ncases = sizeof(cases) / sizeof(cases[0]);
+        int failures = 0;
+
+        for (int i = 0; i < ncases; i++) {
+                if (!check_array(cases[i][0], cases[i][1], cases[i][2])) {
+                        printf("FAIL: %d x %d, blocksize %d\n", cases[i][0],
+                               cases[i][1], cases[i][2]);
+                        failures++;
+                }
+        }
+
+        if (!check_64K_block(100, 90, sizeof(long)) ||
+            !check_64K_block(3, 3, 100 * 1024)) {
+                printf("FAIL: UArray2b_new_64K_block\n");
+                failures++;
+        }
+
+        printf("uarray2b_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_array ********
+ *
+ * Fill an array by position and check what the block-major map returns
+ *
+ * Parameters:
+ *      int width, height:      size of the array
+ *      int blocksize:          cells along one side of a block
+ * Return:
+ *      true if the accessors report the sizes given and the map visits
+ *      every cell once, in order, with the value stored there
+ * Expects:
+ *      the arguments are legal for UArray2b_new. Throws CRE otherwise.
+ * Notes:
+ *      Each cell holds its row-major index, so a wrong cell is caught.
+ ************************/
+bool check_array(int width, int height, int blocksize)
+{
+        UArray2b_T array = UArray2b_new(width, height, sizeof(long),
+                                        blocksize);
+        Visits visits = { 0, -1, -1, -1, true };
+
+        for (int row = 0; row < height && width > 0; row++) {
+                for (int col = 0; col < width; col++) {
+                        *(long *) UArray2b_at(array, col, row) =
+                                (long) row * width + col;
+                }
+        }
+
+        UArray2b_map_block_major(array, check_cell, &visits);
+
+        bool ok = visits.ok &&
+                  visits.count == (long) width * height &&
+                  UArray2b_width(array) == width &&
+                  UArray2b_height(array) == height &&
+                  UArray2b_size(array) == sizeof(long) &&
+                  UArray2b_blocksize(array) == blocksize;
+
+        UArray2b_free(&array);
+
+        return ok && array == NULL;
+}
+
+/******** check_64K_block ********
+ *
+ * Check the blocksize chosen by UArray2b_new_64K_block
+ *
+ * Parameters:
+ *      int width, height:      size of the array
+ *      int size:               bytes per cell, at least sizeof(long)
+ * Return:
+ *      true if one block fits in 64KB (or the blocksize is 1 for a cell
+ *      bigger than that), a block one larger would not, and the map still
+ *      visits every cell
+ * Expects:
+ *      the arguments are legal for UArray2b_new_64K_block. Throws CRE
+ *      otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool check_64K_block(int width, int height, int size)
+{
+        UArray2b_T array = UArray2b_new_64K_block(width, height, size);
+        long bs = UArray2b_blocksize(array);
+        long limit = 64 * 1024;
+        Visits visits = { 0, -1, -1, -1, true };
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        *(long *) UArray2b_at(array, col, row) =
+                                (long) row * width + col;
+                }
+        }
+        UArray2b_map_block_major(array, check_cell, &visits);
+
+        bool fits = bs == 1 || bs * bs * size <= limit;
+        bool largest = (bs + 1) * (bs + 1) * size > limit;
+        bool ok = fits && largest && visits.ok &&
+                  visits.count == width * height;
+
+        UArray2b_free(&array);
+
+        return ok;
+}
+
+/******** check_cell ********
+ *
+ * Map apply function: check one visited cell against the ones before it
+ *
+ * Parameters:
+ *      int col, row:           position of the cell
+ *      UArray2b_T a:           the array being mapped
+ *      void *elem:             pointer to the cell
+ *      void *cl:               the Visits so far
+ * Return:
+ *      nothing; clears visits->ok on any mismatch
+ * Expects:
+ *      cl is not NULL
+ * Notes:
+ *      Visits must move forward by (block, row, col), which together with
+ *      the final count means every cell was visited exactly once.
+ ************************/
+void check_cell(int col, int row, UArray2b_T a, void *elem, void *cl)
+{
+        Visits *visits = cl;
+        int block = block_of(a, col, row);
+        int width = UArray2b_width(a);
+
+        bool in_range = 0 <= col && col < width && 0 <= row &&
+                        row < UArray2b_height(a);
+        bool forward = block > visits->last_block ||
+                       (block == visits->last_block &&
+                        (row > visits->last_row ||
+                         (row == visits->last_row &&
+                          col > visits->last_col)));
+
+        if (!in_range || !forward || elem != UArray2b_at(a, col, row) ||
+            *(long *) elem != (long) row * width + col) {
+                visits->ok = false;
+        }
+
+        visits->count++;
+        visits->last_block = block;
+        visits->last_col = col;
+        visits->last_row = row;
+}
+
+/******** block_of ********
+ *
+ * Return the row-major index of the block holding a cell
+ *
+ * Parameters:
+ *      UArray2b_T a:           the array
+ *      int col, row:           position of the cell
+ * Return:
+ *      the block's index, counting across each row of blocks in turn
+ * Expects:
+ *      a is not NULL
+ * Notes:
+ *      none
+ ************************/
+int block_of(UArray2b_T a, int col, int row)
+{
+        int bs = UArray2b_blocksize(a);
+        int width = UArray2b_width(a);
+        int blocks_wide = width / bs + (width % bs != 0);
+
+        return (row / bs) * blocks_wide + col / bs;
+}
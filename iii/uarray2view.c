@@ -0,0 +1,403 @@
+/*
+ *      uarray2view.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Implementation of zero-copy views over a UArray2. A view only records
+ *      where its cell (0, 0) lives and how many bytes apart its columns and
+ *      rows are, so views of views cost the same as views of the parent.
+ */
+
+#include "uarray2view.h"
+#include "assert.h"
+
+#define T UArray2view_T
+
+struct T
+{
+        int width;
+        int height;
+        int size;
+        char *base;
+        size_t col_stride;
+        size_t row_stride;
+};
+
+static T new_view(char *base, int width, int height, int size,
+                  size_t col_stride, size_t row_stride);
+static bool fits(int col, int row, int width, int height, int col_step,
+                 int row_step, int outer_width, int outer_height);
+
+/******** UArray2view_new ********
+ *
+ * Make a view of a UArray2. Cell (c, r) of the view is cell
+ * (col + c * col_step, row + r * row_step) of the parent.
+ *
+ * Parameters:
+ *      UArray2_T parent:       the array to look into
+ *      int col, int row:       parent coordinates of the view's cell (0, 0)
+ *      int width, int height:  number of columns and rows in the view
+ *      int col_step:           parent columns between adjacent view columns
+ *      int row_step:           parent rows between adjacent view rows
+ * Return:
+ *      a new view
+ * Expects:
+ *      parent is not NULL
+ *      width and height are nonnegative, col_step and row_step are positive
+ *      every cell of the view lies inside the parent
+ *      throws a CRE otherwise, or if malloc fails
+ * Notes:
+ *      none
+ ************************/
+T UArray2view_new(UArray2_T parent, int col, int row, int width, int height,
+                  int col_step, int row_step)
+{
+        assert(parent != NULL);
+        assert(fits(col, row, width, height, col_step, row_step,
+                    UArray2_width(parent), UArray2_height(parent)));
+
+        int size = UArray2_size(parent);
+        char *base = NULL;
+
+        if (width > 0 && height > 0) {
+                base = UArray2_at(parent, col, row);
+        }
+
+        return new_view(base, width, height, size, (size_t) col_step * size,
+                        (size_t) row_step * UArray2_stride(parent));
+}
+
+/******** UArray2view_sub ********
+ *
+ * Make a view of a view, relative to the outer view
+ *
+ * Parameters:
+ *      T view:                 the view to look into
+ *      int col, int row:       view coordinates of the new view's cell (0, 0)
+ *      int width, int height:  number of columns and rows in the new view
+ *      int col_step, int row_step: view cells between adjacent new cells
+ * Return:
+ *      a new view onto the same parent cells
+ * Expects:
+ *      same as UArray2view_new, with view in place of parent
+ * Notes:
+ *      none
+ ************************/
+T UArray2view_sub(T view, int col, int row, int width, int height,
+                  int col_step, int row_step)
+{
+        assert(view != NULL);
+        assert(fits(col, row, width, height, col_step, row_step, view->width,
+                    view->height));
+
+        char *base = NULL;
+
+        if (width > 0 && height > 0) {
+                base = UArray2view_at(view, col, row);
+        }
+
+        return new_view(base, width, height, view->size,
+                        col_step * view->col_stride,
+                        row_step * view->row_stride);
+}
+
+/******** new_view ********
+ *
+ * Allocate and fill in a view
+ *
+ * Parameters:
+ *      char *base:             the view's cell (0, 0), or NULL if empty
+ *      int width, int height:  dimensions of the view
+ *      int size:               bytes per cell
+ *      size_t col_stride:      bytes between adjacent columns
+ *      size_t row_stride:      bytes between adjacent rows
+ * Return:
+ *      the new view
+ * Expects:
+ *      throws a CRE if malloc fails
+ * Notes:
+ *      none
+ ************************/
+static T new_view(char *base, int width, int height, int size,
+                  size_t col_stride, size_t row_stride)
+{
+        T view = malloc(sizeof(*view));
+        assert(view != NULL);
+
+        view->width = width;
+        view->height = height;
+        view->size = size;
+        view->base = base;
+        view->col_stride = col_stride;
+        view->row_stride = row_stride;
+
+        return view;
+}
+
+/******** fits ********
+ *
+ * Check that a stepped region lies inside an outer grid
+ *
+ * Parameters:
+ *      int col, int row:       outer coordinates of the region's first cell
+ *      int width, int height:  region dimensions
+ *      int col_step, int row_step: outer cells between region cells
+ *      int outer_width, int outer_height: dimensions of the outer grid
+ * Return:
+ *      true if the arguments are valid and every region cell is inside
+ * Expects:
+ *      none
+ * Notes:
+ *      An empty region fits anywhere its origin is not negative.
+ ************************/
+static bool fits(int col, int row, int width, int height, int col_step,
+                 int row_step, int outer_width, int outer_height)
+{
+        if (col < 0 || row < 0 || width < 0 || height < 0 || col_step <= 0 ||
+            row_step <= 0) {
+                return false;
+        }
+        if (width == 0 || height == 0) {
+                return true;
+        }
+
+        return col + (long long) (width - 1) * col_step < outer_width &&
+               row + (long long) (height - 1) * row_step < outer_height;
+}
+
+/******** UArray2view_free ********
+ *
+ * Recycle the memory of a view, leaving the parent's cells alone
+ *
+ * Parameters:
+ *      T *view:        pointer to the view to free
+ * Return:
+ *      Nothing, *view is set to NULL
+ * Expects:
+ *      view and *view are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2view_free(T *view)
+{
+        assert(view != NULL && *view != NULL);
+
+        free(*view);
+        *view = NULL;
+}
+
+/******** UArray2view_width ********
+ *
+ * Return the number of columns of a view
+ *
+ * Parameters:
+ *      T view:         the view
+ * Return:
+ *      number of columns
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2view_width(T view)
+{
+        assert(view != NULL);
+
+        return view->width;
+}
+
+/******** UArray2view_height ********
+ *
+ * Return the number of rows of a view
+ *
+ * Parameters:
+ *      T view:         the view
+ * Return:
+ *      number of rows
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2view_height(T view)
+{
+        assert(view != NULL);
+
+        return view->height;
+}
+
+/******** UArray2view_size ********
+ *
+ * Return the number of bytes per cell
+ *
+ * Parameters:
+ *      T view:         the view
+ * Return:
+ *      the parent's cell size
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2view_size(T view)
+{
+        assert(view != NULL);
+
+        return view->size;
+}
+
+/******** UArray2view_at ********
+ *
+ * Return a pointer to cell (col, row) of the view
+ *
+ * Parameters:
+ *      T view:         the view
+ *      int col:        the col of the requested cell
+ *      int row:        the row of the requested cell
+ * Return:
+ *      void pointer to the parent's cell
+ * Expects:
+ *      view is not NULL
+ *      col and row are within [0, width - 1] and [0, height - 1] respectively
+ *      throws CRE otherwise
+ * Notes:
+ *      none
+ ************************/
+void *UArray2view_at(T view, int col, int row)
+{
+        assert(view != NULL && 0 <= col && col < view->width && 0 <= row &&
+               row < view->height);
+
+        return view->base + row * view->row_stride + col * view->col_stride;
+}
+
+/******** UArray2view_row_span ********
+ *
+ * Return a span covering one row of the view
+ *
+ * Parameters:
+ *      T view:         the view
+ *      int row:        the row requested
+ * Return:
+ *      span with count == width
+ * Expects:
+ *      view is not NULL
+ *      row is within [0, height - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2view_row_span(T view, int row)
+{
+        assert(view != NULL && 0 <= row && row < view->height);
+
+        UArray2_span span;
+
+        span.base = NULL;
+        span.count = view->width;
+        span.stride = view->col_stride;
+
+        if (span.count > 0) {
+                span.base = view->base + row * view->row_stride;
+        }
+
+        return span;
+}
+
+/******** UArray2view_col_span ********
+ *
+ * Return a span covering one column of the view
+ *
+ * Parameters:
+ *      T view:         the view
+ *      int col:        the column requested
+ * Return:
+ *      span with count == height
+ * Expects:
+ *      view is not NULL
+ *      col is within [0, width - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2view_col_span(T view, int col)
+{
+        assert(view != NULL && 0 <= col && col < view->width);
+
+        UArray2_span span;
+
+        span.base = NULL;
+        span.count = view->height;
+        span.stride = view->row_stride;
+
+        if (span.count > 0) {
+                span.base = view->base + col * view->col_stride;
+        }
+
+        return span;
+}
+
+/******** UArray2view_map_col_major ********
+ *
+ * Visit each cell of the view in column-major order
+ *
+ * Parameters:
+ *      T view:         the view
+ *      void apply:     function applied to each cell
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      view and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2view_map_col_major(T view,
+        void apply(int col, int row, T view, void *p1, void *p2), void *cl)
+{
+        assert(view != NULL && apply != NULL);
+
+        for (int col = 0; col < view->width; col++) {
+                UArray2_span span = UArray2view_col_span(view, col);
+                char *cell = span.base;
+
+                for (int row = 0; row < span.count; row++) {
+                        apply(col, row, view, cell, cl);
+                        cell += span.stride;
+                }
+        }
+}
+
+/******** UArray2view_map_row_major ********
+ *
+ * Visit each cell of the view in row-major order
+ *
+ * Parameters:
+ *      T view:         the view
+ *      void apply:     function applied to each cell
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      view and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2view_map_row_major(T view,
+        void apply(int col, int row, T view, void *p1, void *p2), void *cl)
+{
+        assert(view != NULL && apply != NULL);
+
+        for (int row = 0; row < view->height; row++) {
+                UArray2_span span = UArray2view_row_span(view, row);
+                char *cell = span.base;
+
+                for (int col = 0; col < span.count; col++) {
+                        apply(col, row, view, cell, cl);
+                        cell += span.stride;
+                }
+        }
+}
+
+#undef T
@@ -0,0 +1,229 @@
+/*
+ *      uarray2view.h
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Header file with function prototypes and function contracts for
+ *      UArray2 views. A view is a rectangular window onto a UArray2 (every
+ *      col_step-th column and row_step-th row of a region) that reads and
+ *      writes the parent's cells directly, so nothing is copied. Views are
+ *      handy for tiling a large grid or handing a sub-region (such as a 3x3
+ *      sudoku box) to a kernel.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "uarray2.h"
+
+#ifndef UARRAY2VIEW_INCLUDED
+#define UARRAY2VIEW_INCLUDED
+
+#define T UArray2view_T
+
+typedef struct T *T;
+
+/******** UArray2view_new ********
+ *
+ * Make a view of a UArray2. Cell (c, r) of the view is cell
+ * (col + c * col_step, row + r * row_step) of the parent.
+ *
+ * Parameters:
+ *      UArray2_T parent:       the array to look into
+ *      int col, int row:       parent coordinates of the view's cell (0, 0)
+ *      int width, int height:  number of columns and rows in the view
+ *      int col_step:           parent columns between adjacent view columns
+ *      int row_step:           parent rows between adjacent view rows
+ * Return:
+ *      a new view
+ * Expects:
+ *      parent is not NULL
+ *      width and height are nonnegative, col_step and row_step are positive
+ *      every cell of the view lies inside the parent
+ *      throws a CRE otherwise, or if malloc fails
+ * Notes:
+ *      The view does not own the parent's cells; the parent must outlive
+ *      the view. A plain sub-rectangle uses steps of 1.
+ ************************/
+T UArray2view_new(UArray2_T parent, int col, int row, int width, int height,
+                  int col_step, int row_step);
+
+/******** UArray2view_sub ********
+ *
+ * Make a view of a view, with the same meaning of coordinates and steps as
+ * UArray2view_new but relative to the outer view
+ *
+ * Parameters:
+ *      T view:                 the view to look into
+ *      int col, int row:       view coordinates of the new view's cell (0, 0)
+ *      int width, int height:  number of columns and rows in the new view
+ *      int col_step, int row_step: view cells between adjacent new cells
+ * Return:
+ *      a new view onto the same parent cells
+ * Expects:
+ *      same as UArray2view_new, with view in place of parent
+ * Notes:
+ *      The new view is independent of view and may outlive it.
+ ************************/
+T UArray2view_sub(T view, int col, int row, int width, int height,
+                  int col_step, int row_step);
+
+/******** UArray2view_free ********
+ *
+ * Recycle the memory of a view, leaving the parent's cells alone
+ *
+ * Parameters:
+ *      T *view:        pointer to the view to free
+ * Return:
+ *      Nothing, *view is set to NULL
+ * Expects:
+ *      view and *view are not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2view_free(T *view);
+
+/******** UArray2view_width ********
+ *
+ * Return the number of columns of a view
+ *
+ * Parameters:
+ *      T view:         the view
+ * Return:
+ *      number of columns
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2view_width(T view);
+
+/******** UArray2view_height ********
+ *
+ * Return the number of rows of a view
+ *
+ * Parameters:
+ *      T view:         the view
+ * Return:
+ *      number of rows
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2view_height(T view);
+
+/******** UArray2view_size ********
+ *
+ * Return the number of bytes per cell
+ *
+ * Parameters:
+ *      T view:         the view
+ * Return:
+ *      the parent's cell size
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int UArray2view_size(T view);
+
+/******** UArray2view_at ********
+ *
+ * Return a pointer to cell (col, row) of the view, which is a cell of the
+ * parent
+ *
+ * Parameters:
+ *      T view:         the view
+ *      int col:        the col of the requested cell
+ *      int row:        the row of the requested cell
+ * Return:
+ *      void pointer to the parent's cell
+ * Expects:
+ *      view is not NULL
+ *      col and row are within [0, width - 1] and [0, height - 1] respectively
+ *      throws CRE otherwise
+ * Notes:
+ *      none
+ ************************/
+void *UArray2view_at(T view, int col, int row);
+
+/******** UArray2view_row_span ********
+ *
+ * Return a span covering one row of the view
+ *
+ * Parameters:
+ *      T view:         the view
+ *      int row:        the row requested
+ * Return:
+ *      span with count == width; stride == size only when col_step is 1
+ * Expects:
+ *      view is not NULL
+ *      row is within [0, height - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2view_row_span(T view, int row);
+
+/******** UArray2view_col_span ********
+ *
+ * Return a span covering one column of the view
+ *
+ * Parameters:
+ *      T view:         the view
+ *      int col:        the column requested
+ * Return:
+ *      span with count == height
+ * Expects:
+ *      view is not NULL
+ *      col is within [0, width - 1]
+ *      CRE otherwise
+ * Notes:
+ *      base is NULL when count is 0
+ ************************/
+UArray2_span UArray2view_col_span(T view, int col);
+
+/******** UArray2view_map_col_major ********
+ *
+ * Visit each cell of the view in column-major order
+ *
+ * Parameters:
+ *      T view:         the view
+ *      void apply:     function applied to each cell, given its view
+ *                      coordinates, the view, a pointer to the cell, and
+ *                      the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      view and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2view_map_col_major(T view,
+        void apply(int col, int row, T view, void *p1, void *p2), void *cl);
+
+/******** UArray2view_map_row_major ********
+ *
+ * Visit each cell of the view in row-major order
+ *
+ * Parameters:
+ *      T view:         the view
+ *      void apply:     function applied to each cell, given its view
+ *                      coordinates, the view, a pointer to the cell, and
+ *                      the closure
+ *      void *cl:       closure pointer for client's implementation
+ * Return:
+ *      nothing
+ * Expects:
+ *      view and apply are not NULL. CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+void UArray2view_map_row_major(T view,
+        void apply(int col, int row, T view, void *p1, void *p2), void *cl);
+
+#undef T
+#endif
@@ -0,0 +1,358 @@
+/*
+ *      uarray2view_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Test for UArray2 views. Every cell of the parent holds its own
+ *      row-major index, so each view and sub-view can be checked cell by
+ *      cell against the parent position it should map to: through
+ *      UArray2view_at, both spans, and both maps. Writes through a view
+ *      must land in the parent.
+ *
+ *      Usage: uarray2view_test
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#include "uarray2.h"
+#include "uarray2view.h"
+#include "assert.h"
+
+/* Size of the parent array */
+#define WIDTH 23
+#define HEIGHT 17
+
+/* Where a view's cells should be found in its parent */
+typedef struct Placement {
+        UArray2_T parent;
+        int col;
+        int row;
+        int col_step;
+        int row_step;
+} Placement;
+
+/* What a map has seen so far, for checking the next cell it visits */
+typedef struct Visits {
+        Placement *place;
+        bool row_major;
+        int count;
+        int last_col;
+        int last_row;
+        bool ok;
+} Visits;
+
+bool check_view(UArray2view_T view, Placement place, int width, int height);
+bool check_spans(UArray2view_T view, Placement place);
+bool check_maps(UArray2view_T view, Placement place);
+void check_cell(int col, int row, UArray2view_T view, void *elem, void *cl);
+bool check_write(UArray2view_T view, Placement place);
+int *expected_cell(Placement place, int col, int row);
+Placement sub_placement(Placement outer, int col, int row, int col_step,
+                        int row_step);
+
+/******** main ********
+ *
+ * Build views and sub-views of a parent array and check each one
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every view checked out, EXIT_FAILURE otherwise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      Two sub-views are checked again after the views they came from are
+ *      freed, since a sub-view may outlive its view.
+ ************************/
+int main(void)
+{
+        static const int cases[][6] = {
+                { 0, 0, WIDTH, HEIGHT, 1, 1 }, { 3, 2, 5, 4, 1, 1 },
+                { 1, 0, 7, 6, 3, 3 },          { 0, 1, 12, 4, 2, 5 },
+                { 22, 16, 1, 1, 4, 4 },        { 4, 4, 0, 3, 1, 1 },
+                { 4, 4, 3, 0, 2, 1 }
+        };
+        int ncases = sizeof(cases) / sizeof(cases[0]);
+        UArray2_T parent = UArray2_new(WIDTH, HEIGHT, sizeof(int));
+        int failures = 0;
+
+        for (int row = 0; row < HEIGHT; row++) {
+                for (int col = 0; col < WIDTH; col++) {
+                        *(int *) UArray2_at(parent, col, row) =
+                                row * WIDTH + col;
+                }
+        }
+
+        for (int i = 0; i < ncases; i++) {
+                const int *c = cases[i];
+                Placement place = { parent, c[0], c[1], c[4], c[5] };
+                UArray2view_T view = UArray2view_new(parent, c[0], c[1],
+                                                     c[2], c[3], c[4], c[5]);
+
+                if (!check_view(view, place, c[2], c[3])) {
+                        printf("FAIL: view at (%d, %d), %d x %d, steps "
+                               "%d, %d\n", c[0], c[1], c[2], c[3], c[4],
+                               c[5]);
+                        failures++;
+                }
+                UArray2view_free(&view);
+        }
+
+        /* A box and a strided sub-view of a view, then a sub-view of the box */
+        Placement outer = { parent, 1, 1, 2, 1 };
+        UArray2view_T view = UArray2view_new(parent, 1, 1, 10, 15, 2, 1);
+        Placement box_place = sub_placement(outer, 3, 6, 1, 1);
+        UArray2view_T box = UArray2view_sub(view, 3, 6, 3, 3, 1, 1);
+        Placement strided_place = sub_placement(outer, 1, 2, 3, 4);
+        UArray2view_T strided = UArray2view_sub(view, 1, 2, 3, 3, 3, 4);
+        Placement inner_place = sub_placement(box_place, 1, 0, 1, 2);
+        UArray2view_T inner = UArray2view_sub(box, 1, 0, 2, 2, 1, 2);
+
+        if (!check_view(box, box_place, 3, 3) ||
+            !check_view(inner, inner_place, 2, 2)) {
+                printf("FAIL: sub-view of a sub-view\n");
+                failures++;
+        }
+
+        UArray2view_free(&box);
+        UArray2view_free(&view);
+
+        if (!check_view(strided, strided_place, 3, 3) ||
+            !check_view(inner, inner_place, 2, 2)) {
+                printf("FAIL: sub-view after its view was freed\n");
+                failures++;
+        }
+
+        UArray2view_free(&strided);
+        UArray2view_free(&inner);
+        UArray2_free(&parent);
+
+        printf("uarray2view_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_view ********
+ *
+ * Check every way of reaching a view's cells
+ *
+ * Parameters:
+ *      UArray2view_T view:     the view under test
+ *      Placement place:        where its cells should be in the parent
+ *      int width, height:      the size it was made with
+ * Return:
+ *      true if the size, cells, spans, maps, and writes all match
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Leaves the parent as it was.
+ ************************/
+bool check_view(UArray2view_T view, Placement place, int width, int height)
+{
+        bool ok = UArray2view_width(view) == width &&
+                  UArray2view_height(view) == height &&
+                  UArray2view_size(view) == sizeof(int);
+
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width && ok; col++) {
+                        ok = UArray2view_at(view, col, row) ==
+                             expected_cell(place, col, row);
+                }
+        }
+
+        return ok && check_spans(view, place) && check_maps(view, place) &&
+               check_write(view, place);
+}
+
+/******** check_spans ********
+ *
+ * Check the row and column spans of a view against the parent
+ *
+ * Parameters:
+ *      UArray2view_T view:     the view under test
+ *      Placement place:        where its cells should be in the parent
+ * Return:
+ *      true if every span element is the expected parent cell
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool check_spans(UArray2view_T view, Placement place)
+{
+        int width = UArray2view_width(view);
+        int height = UArray2view_height(view);
+        bool ok = true;
+
+        for (int row = 0; row < height; row++) {
+                UArray2_span span = UArray2view_row_span(view, row);
+
+                ok = ok && span.count == width;
+                for (int col = 0; col < span.count && ok; col++) {
+                        ok = (char *) span.base + col * span.stride ==
+                             (char *) expected_cell(place, col, row);
+                }
+        }
+        for (int col = 0; col < width; col++) {
+                UArray2_span span = UArray2view_col_span(view, col);
+
+                ok = ok && span.count == height;
+                for (int row = 0; row < span.count && ok; row++) {
+                        ok = (char *) span.base + row * span.stride ==
+                             (char *) expected_cell(place, col, row);
+                }
+        }
+
+        return ok;
+}
+
+/******** check_maps ********
+ *
+ * Check that both maps visit every cell of a view once, in order
+ *
+ * Parameters:
+ *      UArray2view_T view:     the view under test
+ *      Placement place:        where its cells should be in the parent
+ * Return:
+ *      true if both maps hand over the expected cells in their order
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool check_maps(UArray2view_T view, Placement place)
+{
+        int cells = UArray2view_width(view) * UArray2view_height(view);
+        Visits by_row = { &place, true, 0, -1, -1, true };
+        Visits by_col = { &place, false, 0, -1, -1, true };
+
+        UArray2view_map_row_major(view, check_cell, &by_row);
+        UArray2view_map_col_major(view, check_cell, &by_col);
+
+        return by_row.ok && by_row.count == cells &&
+               by_col.ok && by_col.count == cells;
+}
+
+/******** check_cell ********
+ *
+ * Map apply function: check one visited cell against the ones before it
+ *
+ * Parameters:
+ *      int col, row:           view coordinates of the cell
+ *      UArray2view_T view:     the view being mapped
+ *      void *elem:             pointer to the cell
+ *      void *cl:               the Visits so far
+ * Return:
+ *      nothing; clears visits->ok on any mismatch
+ * Expects:
+ *      cl is not NULL
+ * Notes:
+ *      Visits must move forward by (row, col) for a row-major map and by
+ *      (col, row) for a column-major one; with the final count, that means
+ *      every cell was visited exactly once.
+ ************************/
+void check_cell(int col, int row, UArray2view_T view, void *elem, void *cl)
+{
+        Visits *visits = cl;
+        int major = visits->row_major ? row : col;
+        int minor = visits->row_major ? col : row;
+        int last_major = visits->row_major ? visits->last_row :
+                                             visits->last_col;
+        int last_minor = visits->row_major ? visits->last_col :
+                                             visits->last_row;
+        bool forward = major > last_major ||
+                       (major == last_major && minor > last_minor);
+
+        if (!forward || col >= UArray2view_width(view) ||
+            row >= UArray2view_height(view) ||
+            elem != expected_cell(*visits->place, col, row)) {
+                visits->ok = false;
+        }
+
+        visits->count++;
+        visits->last_col = col;
+        visits->last_row = row;
+}
+
+/******** check_write ********
+ *
+ * Check that writes through a view show up in the parent
+ *
+ * Parameters:
+ *      UArray2view_T view:     the view under test
+ *      Placement place:        where its cells should be in the parent
+ * Return:
+ *      true if each negated cell reads back negated through the parent
+ * Expects:
+ *      view is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Every cell is negated and then restored, so the parent is left as
+ *      it was.
+ ************************/
+bool check_write(UArray2view_T view, Placement place)
+{
+        bool ok = true;
+
+        for (int row = 0; row < UArray2view_height(view); row++) {
+                for (int col = 0; col < UArray2view_width(view); col++) {
+                        int pcol = place.col + col * place.col_step;
+                        int prow = place.row + row * place.row_step;
+                        int *cell = UArray2view_at(view, col, row);
+                        int old = *cell;
+
+                        *cell = -old - 1;
+                        ok = ok && *(int *) UArray2_at(place.parent, pcol,
+                                                       prow) == -old - 1;
+                        *cell = old;
+                }
+        }
+
+        return ok;
+}
+
+/******** expected_cell ********
+ *
+ * Return the parent cell a view cell should be
+ *
+ * Parameters:
+ *      Placement place:        where the view's cells are in the parent
+ *      int col, row:           view coordinates
+ * Return:
+ *      pointer to the parent's cell
+ * Expects:
+ *      the cell lies inside the parent. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+int *expected_cell(Placement place, int col, int row)
+{
+        return UArray2_at(place.parent, place.col + col * place.col_step,
+                          place.row + row * place.row_step);
+}
+
+/******** sub_placement ********
+ *
+ * Compose a sub-view's placement with its outer view's
+ *
+ * Parameters:
+ *      Placement outer:        placement of the outer view
+ *      int col, row:           outer coordinates of the sub-view's (0, 0)
+ *      int col_step, row_step: outer cells between adjacent sub-view cells
+ * Return:
+ *      the sub-view's placement in the parent
+ * Expects:
+ *      none
+ * Notes:
+ *      none
+ ************************/
+Placement sub_placement(Placement outer, int col, int row, int col_step,
+                        int row_step)
+{
+        Placement inner = { outer.parent,
+                            outer.col + col * outer.col_step,
+                            outer.row + row * outer.row_step,
+                            outer.col_step * col_step,
+                            outer.row_step * row_step };
+
+        return inner;
+}
@@ -7,28 +7,196 @@
  *      Implementation of removing black edges from a PBM
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "bit2.h"
+#include "bit2cc.h"
+#include "pbmread.h"
+#include "pbmwrite.h"
 #include "assert.h"
 #include <pnmrdr.h>
-#include <stack.h>
 
-typedef struct element Element;
+/* Select the fixpoint, streaming, threaded or pipelined engine instead of
+ * the flood fill. The threaded flag may name a thread count, as
+ * --parallel=4 */
+#define PROPAGATE_FLAG "--propagate"
+#define STREAM_FLAG "--stream"
+#define PARALLEL_FLAG "--parallel"
+#define PIPELINE_FLAG "--pipeline"
+
+/* Write the result as a raw (P4) PBM instead of a plain (P1) one */
+#define RAW_FLAG "--raw"
+
+/* Starting capacity of the flood fill worklist, in pixels */
+#define WORKLIST_START 1024
+
+/* Pixels a pipeline stage handles before passing its rows on */
+#define PIPELINE_BATCH_PIXELS 65536
+
+typedef enum { FLOOD_FILL, PROPAGATE, STREAM, PARALLEL, PIPELINE } Engine;
+
+typedef struct options Options;
+
+/* What the command-line flags asked for */
+struct options {
+        Engine engine;
+        int nthreads;
+        bool raw;
+};
+
+typedef struct worklist Worklist;
+
+/*
+ * Pixels whose black runs are waiting to be cleared, packed as
+ * (row << 32) | col. A pixel is whitened when it is pushed, so no pixel is
+ * ever pushed twice and count never exceeds the number of pixels.
+ */
+struct worklist {
+        uint64_t *items;
+        size_t count;
+        size_t capacity;
+};
+
+typedef struct run Run;
+
+/* One horizontal run of black pixels, columns [start, end), in a row */
+struct run {
+        int start;
+        int end;
+        uint32_t label;
+};
+
+typedef struct runs Runs;
+
+/* The black runs of one row, in order from left to right */
+struct runs {
+        Run *items;
+        int count;
+};
+
+typedef struct row_comps RowComps;
+
+/*
+ * The black runs of one row for the streaming engine, grouped into the
+ * components they belong to through the rows above. comp[k] is run k's
+ * component, and border[c] is whether component c touches the border so
+ * far.
+ */
+struct row_comps {
+        Runs runs;
+        uint32_t *comp;
+        unsigned char *border;
+        int count;
+};
+
+/* Fates of a streamed component that does not reach the next row */
+#define CLOSED_INSIDE UINT32_MAX
+#define CLOSED_BORDER (UINT32_MAX - 1)
+
+typedef struct labels Labels;
+
+/*
+ * Union-find over black runs, labeled in row-major order (or, for the
+ * streaming engine, over two rows' components and runs at a time).
+ * border[label] is meaningful at roots: whether the component touches the
+ * border.
+ */
+struct labels {
+        uint32_t *parent;
+        unsigned char *border;
+        size_t count;
+        size_t capacity;
+};
+
+typedef struct run_log RunLog;
+
+/*
+ * The black runs the pipelined engine has labeled and still needs, in
+ * row-major order: those of the unsettled rows and of the last row
+ * labeled, plus any settled ones not yet compacted away. Row r's runs are
+ * items[row_start[r]] up to items[row_start[r + 1]], for rows still held.
+ */
+struct run_log {
+        Run *items;
+        size_t count;
+        size_t capacity;
+        size_t *row_start;
+};
+
+typedef struct progress Progress;
 
-struct element {
-        int col;
-        int row;
+/* How many rows, from the top, one pipeline stage has handed on */
+struct progress {
+        pthread_mutex_t lock;
+        pthread_cond_t moved;
+        int rows;
+};
+
+typedef struct pipeline Pipeline;
+
+/*
+ * State shared by the three pipeline stages. Rows below read.rows are
+ * parsed into bit2, and rows below done.rows are whitened and final. Each
+ * stage only writes rows the next stage has not been handed yet, and Bit2
+ * rows never share a word, so the stages never touch the same word.
+ */
+struct pipeline {
+        Pbmread_T reader;
+        Bit2_T bit2;
+        bool raw;
+        int batch;
+        Progress read;
+        Progress done;
 };
 
 /* Helper function prototypes */
+void parse_flag(char *flag, Options *options);
 Bit2_T initializeBitMap(int argc, char *argv[]);
 FILE *openFile(int argc, char *argv[]);
-void populate(int col, int row, Bit2_T bit2, int value, void *rdr_vp);
-void find_black_edges(int col, int row, Bit2_T bit2, int b, void *stack);
-void check_neighbors(int col, int row, Stack_T stack, Bit2_T bit2);
-void process_stack(Stack_T stack, Bit2_T bit2);
-void process_element(Stack_T stack, Bit2_T bit2);
-void push_to_stack(int col, int row, Stack_T stack, Bit2_T);
-void print_solution(int col, int row, Bit2_T bit2, int b, void *cl);
+void find_black_edges(int col, int row, Bit2_T bit2, int b, void *worklist);
+void check_neighbors(int col, int row, Worklist *worklist, Bit2_T bit2);
+void process_worklist(Worklist *worklist, Bit2_T bit2);
+void process_element(Worklist *worklist, Bit2_T bit2);
+void push_runs(int left, int right, int row, Worklist *worklist, Bit2_T bit2);
+void push_if_black(int col, int row, Worklist *worklist, Bit2_T bit2);
+void remove_by_propagation(Bit2_T bit2);
+void stream_unblackedges(int argc, char *argv[], bool raw);
+void label_rows(Pnmrdr_T rdr, int height, Bit2_T line, uint64_t *words,
+                FILE *spill, FILE *links);
+void link_rows(RowComps *above, RowComps *current, bool edge_row, int width,
+               Labels *labels, uint32_t *fate, uint32_t *index);
+void settle_rows(FILE *spill, FILE *links, int height, Bit2_T line,
+                 uint64_t *words);
+void write_rows(FILE *spill, int height, Bit2_T line, uint64_t *words,
+                bool raw);
+void write_links(FILE *links, RowComps *comps, uint32_t *fate);
+int read_links(FILE *links, off_t *end, RowComps *comps, uint32_t *fate);
+RowComps new_row_comps(size_t room);
+void free_row_comps(RowComps *comps);
+void read_row(Pnmrdr_T rdr, FILE *spill, Bit2_T line, uint64_t *words);
+void spill_row(FILE *spill, Bit2_T line, uint64_t *words);
+void collect_run(int row, int start, int length, int bit, Bit2_T line,
+                 void *runs);
+uint32_t new_label(Labels *labels, bool border);
+uint32_t find_label(Labels *labels, uint32_t label);
+void join_labels(Labels *labels, uint32_t a, uint32_t b);
+void pipeline_unblackedges(int argc, char *argv[], bool raw);
+void *read_stage(void *pipeline);
+void label_stage(Pipeline *pipeline);
+void *write_stage(void *pipeline);
+void label_row(Bit2_T bit2, int row, Labels *labels, RunLog *log);
+void compact_log(Labels *labels, RunLog *log, int keep, int row);
+bool row_closed(Labels *labels, RunLog *log, int row, uint32_t *open,
+                size_t nopen);
+void whiten_row(Bit2_T bit2, int row, Labels *labels, RunLog *log);
+int compare_labels(const void *a, const void *b);
+void init_progress(Progress *progress);
+void advance(Progress *progress, int rows);
+int wait_past(Progress *progress, int rows);
 
 /******** main ********
  *
@@ -42,27 +210,110 @@ void print_solution(int col, int row, Bit2_T bit2, int b, void *cl);
  * Expects:
  *      None
  * Notes: 
- *      None
+ *      Flags come before the file name. --propagate removes the edges with
+ *      the bit-parallel fixpoint instead of the flood fill, --stream with
+ *      the bounded-memory streaming engine, and --parallel[=N] with N
+ *      threads (one per processor by default), or with the flood fill
+ *      when that comes to a single thread. --pipeline reads, cleans
+ *      and prints at the same time, printing rows as soon as they are
+ *      final. The result is the same every way. --raw writes it as a raw
+ *      (P4) PBM.
  ************************/
 int main (int argc, char *argv[])
 {
+        Options options = { FLOOD_FILL, 0, false };
+
+        /* Drop each flag so argv[1] is the file name, if any */
+        while (argc > 1 && strncmp(argv[1], "--", 2) == 0) {
+                parse_flag(argv[1], &options);
+                argc--;
+                argv++;
+        }
+
+        /* One thread has no parallelism to win back the labelling costs */
+        if (options.engine == PARALLEL && options.nthreads <= 0) {
+                options.nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if (options.engine == PARALLEL && options.nthreads <= 1) {
+                options.engine = FLOOD_FILL;
+        }
+
+        if (options.engine == STREAM) {
+                stream_unblackedges(argc, argv, options.raw);
+                return 0;
+        } else if (options.engine == PIPELINE) {
+                pipeline_unblackedges(argc, argv, options.raw);
+                return 0;
+        }
+
         /* Initialize Data Structures */
         Bit2_T bit2 = initializeBitMap(argc, argv);
-        Stack_T stack = Stack_new();
+        Worklist worklist = { NULL, 0, 0 };
 
-        Bit2_map_row_major(bit2, find_black_edges, stack);
-        
-        Bit2_map_row_major(bit2, print_solution, stack);
+        if (options.engine == PROPAGATE) {
+                remove_by_propagation(bit2);
+        } else if (options.engine == PARALLEL) {
+                Bit2cc_clear_border(bit2, options.nthreads);
+        } else {
+                Bit2_map_row_major(bit2, find_black_edges, &worklist);
+        }
+
+        if (options.raw) {
+                Pbmwrite_raw(stdout, bit2);
+        } else {
+                Pbmwrite_plain(stdout, bit2);
+        }
 
-        Stack_free(&stack);
+        free(worklist.items);
         Bit2_free(&bit2);
 
         return 0;
 }
 
+/******** parse_flag ********
+ *
+ * Record what one command-line flag asks for
+ *
+ * Parameters:
+ *      char *flag:             the flag, starting with "--"
+ *      Options *options:       options to update
+ * Return: 
+ *      none
+ * Expects:
+ *      flag is one of the flags main describes, and a --parallel thread
+ *      count is positive. Throws CRE otherwise.
+ * Notes: 
+ *      A later engine flag replaces an earlier one.
+ ************************/
+void parse_flag(char *flag, Options *options)
+{
+        size_t parallel_len = strlen(PARALLEL_FLAG);
+
+        if (strcmp(flag, PROPAGATE_FLAG) == 0) {
+                options->engine = PROPAGATE;
+        } else if (strcmp(flag, STREAM_FLAG) == 0) {
+                options->engine = STREAM;
+        } else if (strcmp(flag, PIPELINE_FLAG) == 0) {
+                options->engine = PIPELINE;
+        } else if (strcmp(flag, RAW_FLAG) == 0) {
+                options->raw = true;
+        } else {
+                assert(strncmp(flag, PARALLEL_FLAG, parallel_len) == 0);
+
+                char *count = flag + parallel_len;
+                options->engine = PARALLEL;
+                if (*count == '=') {
+                        options->nthreads = atoi(count + 1);
+                        assert(options->nthreads > 0);
+                } else {
+                        assert(*count == '\0');
+                }
+        }
+}
+
 /******** initializeBitMap ********
  *
- * Read info from pgm and copy into bitmap
+ * Read info from pbm and copy into bitmap
  *
  * Parameters:
  *      int argc:       argument count
@@ -72,29 +323,15 @@ int main (int argc, char *argv[])
  * Expects:
  *      None
  * Notes: 
- *      Prints header of PBM to standard output here
+ *      Takes plain (P1) and raw (P4) PBMs. Pbmread_read packs pixels
+ *      straight into row words, mapping the file when it can.
  ************************/
 Bit2_T initializeBitMap(int argc, char *argv[])
 {
-        /* Set up PGM information */
         FILE *fp = openFile(argc, argv);
-        Pnmrdr_T rdr = Pnmrdr_new(fp);
-        Pnmrdr_mapdata data = Pnmrdr_data(rdr);
-
-        /* Ensure image is PBM format */
-        assert(data.type == 1);
-
-        /* Declare blank 2D array of PBM's dimensions */
-        Bit2_T bit2 = Bit2_new(data.width, data.height);
-        
-        /* Populate the array with pnmrdr content */
-        Bit2_map_row_major(bit2, populate, rdr);
-
-        /* Output Header to standard output */
-        printf("P1\n%d %d\n", data.width, data.height);
+        Bit2_T bit2 = Pbmread_read(fp);
 
         fclose(fp);
-        Pnmrdr_free(&rdr);
 
         return bit2;
 }
@@ -136,37 +373,6 @@ FILE *openFile(int argc, char *argv[])
         return fp;
 }
 
-/******** populate ********
- *
- * Take a bit from file and input it into a slot of bit2 map
- *
- * Parameters:
- *      int col:        col integer of element
- *      int row:        row integer of element
- *      Bit2_T bit2:    bit2 object
- *      int value:      bit element at (col, row)
- *      void *rdr_vp:   void pointer to reader 
- * Return: 
- *      none
- * Expects:
- *      bit2 and rdr_vp are not NULL. Throws CRE otherwise.
- * Notes: 
- *      This function is called by bit mapping functions. 
- ************************/
-void populate(int col, int row, Bit2_T bit2, int value, void *rdr_vp)
-{       
-        assert(bit2 != NULL && rdr_vp != NULL);
-        
-        /* Eliminate warning for unused argument */
-        (void) value;
-
-        /* Convert void pointers to usable pointers */
-        Pnmrdr_T rdr_copy = rdr_vp;
-
-        /* Set value within array to the next data element in pnmrdr */
-        Bit2_put(bit2, col, row, Pnmrdr_get(rdr_copy));
-}
-
 /******** find_black_edges ********
  *
  * Search for patient 0
@@ -176,194 +382,1360 @@ void populate(int col, int row, Bit2_T bit2, int value, void *rdr_vp)
  *      int row:        row integer of element
  *      Bit2_T bit2:    bit2 map of image data
  *      int value:      bit element at (col, row)
- *      void *stack:    void pointer to stack
+ *      void *worklist: void pointer to the flood fill worklist
  * Return: 
  *      none
  * Expects:
- *      bit2 and stack are not NULL. Throws CRE otherwise.
+ *      bit2 and worklist are not NULL. Throws CRE otherwise.
  * Notes: 
  *      This function is called by bit mapping functions. 
  ************************/
-void find_black_edges(int col, int row, Bit2_T bit2, int b, void *stack) 
+void find_black_edges(int col, int row, Bit2_T bit2, int b, void *worklist) 
 {
-        assert(bit2 != NULL && stack != NULL);
+        assert(bit2 != NULL && worklist != NULL);
         
         (void) b;
         
         if (col == 0 || row == 0 || col == Bit2_width(bit2) - 1 ||
                 row == Bit2_height(bit2) - 1) {
-                check_neighbors(col, row, stack, bit2);
+                check_neighbors(col, row, worklist, bit2);
         }
 }
 
 /******** check_neighbors ********
  *
- * traverse bitmap for connected black edges. Search all possible neighbors
- * and process stack accordingly.
+ * traverse bitmap for connected black edges. Start a fill from an edge pixel
+ * if it is black, and whiten everything connected to it.
  *
  * Parameters:
- *      int col:        col integer of element
- *      int row:        row integer of element
- *      Stack_T stack:  stack object
- *      Bit2_T bit2:    bit2 map of image data
+ *      int col:                col integer of element
+ *      int row:                row integer of element
+ *      Worklist *worklist:     the flood fill worklist
+ *      Bit2_T bit2:            bit2 map of image data
  * Return: 
- *      0 if successful program run
+ *      none
  * Expects:
  *      None
  * Notes: 
- *      None
+ *      The worklist is always empty between edge pixels.
  ************************/
-void check_neighbors(int col, int row, Stack_T stack, Bit2_T bit2)
+void check_neighbors(int col, int row, Worklist *worklist, Bit2_T bit2)
 {
-        /* ALWAYS check at before every iteration if stack is populated */
-        if (Stack_empty(stack) == false) {
-                process_stack(stack, bit2);
-        }
-        /* Check if edge bit is black and push accordingly */
-        int bit = Bit2_get(bit2, col, row);
-        if (bit == 1) {
-                push_to_stack(col, row, stack, bit2);
-        }
+        push_if_black(col, row, worklist, bit2);
+        process_worklist(worklist, bit2);
 }
 
-/******** process_stack ********
+/******** process_worklist ********
  *
- * Loop through stack and whiten black edges until stack is empty.
+ * Pop pixels off the worklist until it is empty, clearing their runs and
+ * pushing the runs next to them as we go.
  *
  * Parameters:
- *      Stack_T stack:  stack of coordiates that may or may not need to be 
- *                      whitened
- *      Bit2_T bit2:    bit2 map of image data
+ *      Worklist *worklist:     pixels whose runs still need clearing
+ *      Bit2_T bit2:            bit2 map of image data
  * Return: 
  *      none
  * Expects:
- *      stack and bit2 are not NULL. Throws CRE otherwise. 
+ *      worklist and bit2 are not NULL. Throws CRE otherwise. 
  * Notes: 
- *      drives loop to iterate through stack. Pushing / popping is elsewhere.
+ *      drives loop to iterate through worklist. Pushing / popping is
+ *      elsewhere.
  ************************/
-void process_stack(Stack_T stack, Bit2_T bit2)
+void process_worklist(Worklist *worklist, Bit2_T bit2)
 {
-        assert(stack != NULL && bit2 != NULL);
+        assert(worklist != NULL && bit2 != NULL);
 
-        while (Stack_empty(stack) == false) {
-                process_element(stack, bit2);
+        while (worklist->count > 0) {
+                process_element(worklist, bit2);
         }
 }
 
 /******** process_element ********
  *
- * Determine if specific element must be whitened and add neighbors to stack for
- * future checking. 
+ * Pop one pixel, whiten the whole horizontal run of black it belongs to,
+ * and push one pixel from each black run touching it in the rows above and
+ * below.
  *
  * Parameters:
- *      Stack_T stack:  stack of coordinates that may or may not need to be 
- *                      whitened
- *      Bit2_T bit2:    bit2 map of image data
+ *      Worklist *worklist:     pixels whose runs still need clearing
+ *      Bit2_T bit2:            bit2 map of image data
  * Return: 
  *      none
  * Expects:
- *      stack and bit2 are not NULL. Throws CRE otherwise. 
+ *      worklist and bit2 are not NULL, and worklist is not empty.
+ *      Throws CRE otherwise. 
  * Notes: 
- *      Here is where pushing / popping logic occurs.
- *      element is malloc'd in push_to_stack(), here is where we pop and thus 
- *      free
+ *      The popped pixel was already whitened when it was pushed, so the run
+ *      is found by scanning out from its neighbors. Run ends are found and
+ *      runs are cleared a word at a time, so a long black border costs one
+ *      push per run instead of four probes per pixel.
  ************************/
-void process_element(Stack_T stack, Bit2_T bit2)
+void process_element(Worklist *worklist, Bit2_T bit2)
 {
-        assert(stack != NULL && bit2 != NULL);
-        assert(Stack_empty(stack) == false);
-        
-        /* Retrieve current element from stack */
-        Element *elem = Stack_pop(stack); 
+        assert(worklist != NULL && bit2 != NULL);
+        assert(worklist->count > 0);
         
-        /* Ensure current pixel is not white as to not check neighbors */
-        if (Bit2_get(bit2, elem->col, elem->row) == 0) {
-                /* Nothing left to process from this point */
-                free(elem);
+        /* Retrieve current element from worklist */
+        uint64_t item = worklist->items[--worklist->count];
+        int col = (int) (item & UINT32_MAX);
+        int row = (int) (item >> 32);
+
+        /* Widen to the whole black run and set it to white */
+        int left = Bit2_prev(bit2, col - 1, row, 0) + 1;
+        int right = Bit2_next(bit2, col + 1, row, 0);
+        Bit2_fill_rect(bit2, left, row, right - left, 1, 0);
+
+        push_runs(left, right, row - 1, worklist, bit2);
+        push_runs(left, right, row + 1, worklist, bit2);
+}
+
+/******** push_runs ********
+ *
+ * Push one pixel from each black run in a row that overlaps the columns
+ * [left, right)
+ *
+ * Parameters:
+ *      int left:               first column of the cleared run
+ *      int right:              column just past the cleared run
+ *      int row:                row to look in, possibly out of range
+ *      Worklist *worklist:     pixels whose runs still need clearing
+ *      Bit2_T bit2:            bit2 map of image data
+ * Return: 
+ *      none
+ * Expects:
+ *      worklist and bit2 are not NULL. Throws CRE otherwise.
+ * Notes: 
+ *      Rows outside the image are skipped rather than throwing CRE.
+ ************************/
+void push_runs(int left, int right, int row, Worklist *worklist, Bit2_T bit2)
+{
+        assert(worklist != NULL && bit2 != NULL);
+
+        if (row < 0 || row >= Bit2_height(bit2)) {
                 return;
         }
 
-        /* Otherwise, element is black. Push neighbors and set to white */
-        push_to_stack(elem->col - 1, elem->row, stack, bit2);
-        push_to_stack(elem->col + 1, elem->row, stack, bit2);
-        push_to_stack(elem->col, elem->row + 1, stack, bit2);
-        push_to_stack(elem->col, elem->row - 1, stack, bit2);
+        int col = Bit2_next(bit2, left, row, 1);
 
-        /* set to white */
-        Bit2_put(bit2, elem->col, elem->row, 0);
-
-        /* Recycle memory of processed element. No longer necessary */
-        free(elem);
+        while (col < right) {
+                push_if_black(col, row, worklist, bit2);
+                int end = Bit2_next(bit2, col + 1, row, 0);
+                col = Bit2_next(bit2, end, row, 1);
+        }
 }
 
-/******** push_to_stack ********
+/******** push_if_black ********
  *
- * For a given set of coordinates, push said coords to the stack for future
- * processing.
+ * For a given set of coordinates, whiten the pixel and push it onto the
+ * worklist if it is in range and black.
  *
  * Parameters:
- *      int col:        column index of bit
- *      int row:        row index of bit
- *      Stack_T stack:  stack of coordiates that may or may not need to be 
- *                      whitened
- *      Bit2_T bit2:    bit2 map of image data
+ *      int col:                column index of bit
+ *      int row:                row index of bit
+ *      Worklist *worklist:     pixels whose runs still need clearing
+ *      Bit2_T bit2:            bit2 map of image data
  * Return: 
  *      none
  * Expects:
- *      stack and bit2 are not NULL. 
- *      Throws CRE otherwise. 
+ *      worklist and bit2 are not NULL. 
+ *      Throws CRE otherwise, or if the worklist cannot grow.
  * Notes: 
  *      Checks to see if column and row are within range. Otherwise, we simply
- *      don't add to stack rather than throwing CRE. 
- *      We are mallocing each struct here, so be sure to free!
+ *      don't push rather than throwing CRE. 
+ *      Whitening on push is what keeps a pixel from being pushed twice. The
+ *      worklist doubles when full, but never past one slot per pixel.
  ************************/
-void push_to_stack(int col, int row, Stack_T stack, Bit2_T bit2)
+void push_if_black(int col, int row, Worklist *worklist, Bit2_T bit2)
 {
-        assert(stack != NULL && bit2 != NULL);
+        assert(worklist != NULL && bit2 != NULL);
+
+        int width = Bit2_width(bit2);
+        int height = Bit2_height(bit2);
 
         /* Ensure col and row are within range, move on otherwise */
-        if(col < 0 || col >= Bit2_width(bit2) || row < 0 || 
-                row >= Bit2_height(bit2)) {
+        if (col < 0 || col >= width || row < 0 || row >= height ||
+            Bit2_put(bit2, col, row, 0) == 0) {
                 return;
         }
 
-        Element *elem = malloc(sizeof(Element));
-        assert(elem != NULL);
+        if (worklist->count == worklist->capacity) {
+                size_t pixels = (size_t) width * height;
+                size_t capacity = worklist->capacity == 0 ? WORKLIST_START :
+                                  worklist->capacity * 2;
 
-        elem->col = col;
-        elem->row = row;
+                if (capacity > pixels) {
+                        capacity = pixels;
+                }
+                worklist->items = realloc(worklist->items,
+                                          capacity * sizeof(uint64_t));
+                assert(worklist->items != NULL);
+                worklist->capacity = capacity;
+        }
 
-        Stack_push(stack, elem);
+        worklist->items[worklist->count++] = (uint64_t) row << 32 |
+                                             (uint32_t) col;
 }
 
-/******** print_solution ********
+/******** remove_by_propagation ********
  *
- * print every bit to standard output
+ * Whiten every black pixel connected to the border, without a worklist
  *
  * Parameters:
- *      int col:        col integer of element
- *      int row:        row integer of element
  *      Bit2_T bit2:    bit2 map of image data
- *      int b:          bit element at (col, row)
- *      void *cl:       unused closure pointer
  * Return: 
  *      none
  * Expects:
  *      bit2 is not NULL. Throws CRE otherwise.
  * Notes: 
- *      Depending on what col and row index are, either print new line or space
+ *      Seeds a second bitmap with the black border pixels, grows it to a
+ *      fixpoint inside the image with Bit2_reconstruct, and clears that
+ *      set from the image with one AND-NOT.
  ************************/
-void print_solution(int col, int row, Bit2_T bit2, int b, void *cl) 
+void remove_by_propagation(Bit2_T bit2)
 {
         assert(bit2 != NULL);
-        (void) cl;
 
-        printf("%d", b);
+        int width = Bit2_width(bit2);
+        int height = Bit2_height(bit2);
+
+        if (width == 0 || height == 0) {
+                return;
+        }
+
+        Bit2_T edges = Bit2_new(width, height);
+
+        Bit2_fill_rect(edges, 0, 0, width, 1, 1);
+        Bit2_fill_rect(edges, 0, height - 1, width, 1, 1);
+        Bit2_fill_rect(edges, 0, 0, 1, height, 1);
+        Bit2_fill_rect(edges, width - 1, 0, 1, height, 1);
+
+        Bit2_reconstruct(edges, bit2);
+        Bit2_combine(bit2, edges, BIT2_MINUS);
+
+        Bit2_free(&edges);
+}
+
+/******** stream_unblackedges ********
+ *
+ * Remove black edges while keeping only a few rows' worth of state in
+ * memory
+ *
+ * Parameters:
+ *      int argc:       argument count
+ *      char *argv[]:   argument array to access filename
+ *      bool raw:       whether to write a raw (P4) PBM instead of plain
+ * Return: 
+ *      none
+ * Expects:
+ *      argc is 1 or 2, and the input is a PBM. Throws CRE otherwise, or if
+ *      a temporary file cannot be made.
+ * Notes: 
+ *      Three passes. label_rows reads the image once, saving it to a
+ *      temporary file as packed rows (one bit per pixel), and saves to a
+ *      second file how each row's components carry on into the row below.
+ *      settle_rows walks those links back up from the bottom, where every
+ *      component's fate is finally known, and whitens the saved rows in
+ *      place. write_rows then prints them. Resident memory is a constant
+ *      number of rows of runs and components, however tall the image or
+ *      however many runs it has; the temporary files hold the rest.
+ ************************/
+void stream_unblackedges(int argc, char *argv[], bool raw)
+{
+        FILE *fp = openFile(argc, argv);
+        Pnmrdr_T rdr = Pnmrdr_new(fp);
+        Pnmrdr_mapdata data = Pnmrdr_data(rdr);
+
+        /* Ensure image is PBM format */
+        assert(data.type == 1);
+
+        FILE *spill = tmpfile();
+        FILE *links = tmpfile();
+        assert(spill != NULL && links != NULL);
+
+        Bit2_T line = Bit2_new(data.width, 1);
+        uint64_t *words = malloc((Bit2_words_per_row(line) + 1) *
+                                 sizeof(uint64_t));
+        assert(words != NULL);
+
+        /* Output Header to standard output */
+        printf("P%d\n%d %d\n", raw ? 4 : 1, data.width, data.height);
+
+        label_rows(rdr, data.height, line, words, spill, links);
+        Pnmrdr_free(&rdr);
+        fclose(fp);
+
+        settle_rows(spill, links, data.height, line, words);
+        write_rows(spill, data.height, line, words, raw);
+
+        fclose(links);
+        fclose(spill);
+        Bit2_free(&line);
+        free(words);
+}
+
+/******** label_rows ********
+ *
+ * First streaming pass: save every row, and link each row's components to
+ * the components they become in the row below
+ *
+ * Parameters:
+ *      Pnmrdr_T rdr:   reader positioned at the first pixel
+ *      int height:     number of rows to read
+ *      Bit2_T line:    one-row bitmap to read each row into
+ *      uint64_t *words: room for one packed row
+ *      FILE *spill:    where to save each row as packed words
+ *      FILE *links:    where to save each row's links
+ * Return: 
+ *      none
+ * Expects:
+ *      all arguments are not NULL. Throws CRE otherwise, or if malloc or a
+ *      write fails.
+ * Notes: 
+ *      A row's components are its black runs grouped by what they connect
+ *      to through the rows above. An empty row past the bottom closes
+ *      whatever is still open, so every row gets its links.
+ ************************/
+void label_rows(Pnmrdr_T rdr, int height, Bit2_T line, uint64_t *words,
+                FILE *spill, FILE *links)
+{
+        assert(rdr != NULL && line != NULL && words != NULL &&
+               spill != NULL && links != NULL);
+
+        int width = Bit2_width(line);
+        size_t room = (size_t) width / 2 + 1;
+        RowComps above = new_row_comps(room);
+        RowComps current = new_row_comps(room);
+        Labels labels = { NULL, NULL, 0, 0 };
+        uint32_t *fate = malloc(room * sizeof(uint32_t));
+        uint32_t *index = malloc(2 * room * sizeof(uint32_t));
+        assert(fate != NULL && index != NULL);
+
+        for (int row = 0; row <= height; row++) {
+                current.runs.count = 0;
+                if (row < height) {
+                        read_row(rdr, NULL, line, words);
+                        spill_row(spill, line, words);
+                        Bit2_map_runs(line, collect_run, &current.runs);
+                }
+
+                link_rows(&above, &current, row == 0 || row == height - 1,
+                          width, &labels, fate, index);
+                if (row > 0) {
+                        write_links(links, &above, fate);
+                }
+
+                RowComps swap = above;
+                above = current;
+                current = swap;
+        }
+
+        free_row_comps(&above);
+        free_row_comps(&current);
+        free(labels.parent);
+        free(labels.border);
+        free(fate);
+        free(index);
+}
+
+/******** link_rows ********
+ *
+ * Group a row's runs into components, and find where each component of the
+ * row above went
+ *
+ * Parameters:
+ *      RowComps *above:        the row above, with its components
+ *      RowComps *current:      the row's runs; its components are filled in
+ *      bool edge_row:          whether the row is the top or bottom row
+ *      int width:              width of the image
+ *      Labels *labels:         union-find to reuse as scratch
+ *      uint32_t *fate:         room for one entry per component above
+ *      uint32_t *index:        room for one entry per component above plus
+ *                              one per run
+ * Return: 
+ *      none; fate[p] is the component of this row that component p above
+ *      became, or CLOSED_INSIDE or CLOSED_BORDER if it ended
+ * Expects:
+ *      all pointers are not NULL. Throws CRE otherwise.
+ * Notes: 
+ *      The union-find starts over for every row, with one node per
+ *      component above and one per run, so it never outgrows two rows.
+ *      Runs in adjacent rows touch when their columns overlap, and both
+ *      rows' runs are in order, so one forward walk finds every overlap.
+ ************************/
+void link_rows(RowComps *above, RowComps *current, bool edge_row, int width,
+               Labels *labels, uint32_t *fate, uint32_t *index)
+{
+        assert(above != NULL && current != NULL && labels != NULL &&
+               fate != NULL && index != NULL);
+
+        int nabove = above->count;
+        Runs *runs = &current->runs;
+
+        labels->count = 0;
+        for (int p = 0; p < nabove; p++) {
+                new_label(labels, above->border[p]);
+        }
+
+        int first = 0;
+        for (int k = 0; k < runs->count; k++) {
+                Run *run = &runs->items[k];
+                uint32_t node = new_label(labels, edge_row ||
+                                          run->start == 0 ||
+                                          run->end == width);
+
+                /* Runs above that end before this one never touch a later
+                 * one either */
+                while (first < above->runs.count &&
+                       above->runs.items[first].end <= run->start) {
+                        first++;
+                }
+                for (int j = first; j < above->runs.count &&
+                     above->runs.items[j].start < run->end; j++) {
+                        join_labels(labels, above->comp[j], node);
+                }
+        }
+
+        /* Number this row's components in order of their first run */
+        for (size_t i = 0; i < labels->count; i++) {
+                index[i] = CLOSED_INSIDE;
+        }
+        current->count = 0;
+        for (int k = 0; k < runs->count; k++) {
+                uint32_t root = find_label(labels, nabove + k);
+
+                if (index[root] == CLOSED_INSIDE) {
+                        index[root] = current->count;
+                        current->border[current->count++] =
+                                labels->border[root];
+                }
+                current->comp[k] = index[root];
+        }
+
+        for (int p = 0; p < nabove; p++) {
+                uint32_t root = find_label(labels, p);
+
+                fate[p] = index[root];
+                if (fate[p] == CLOSED_INSIDE && labels->border[root]) {
+                        fate[p] = CLOSED_BORDER;
+                }
+        }
+}
+
+/******** settle_rows ********
+ *
+ * Second streaming pass: from the bottom row up, work out which components
+ * reach the border and whiten their runs in the saved rows
+ *
+ * Parameters:
+ *      FILE *spill:    the rows saved by label_rows, whitened in place
+ *      FILE *links:    the links saved by label_rows
+ *      int height:     number of rows
+ *      Bit2_T line:    one-row bitmap to work on each row in
+ *      uint64_t *words: room for one packed row
+ * Return: 
+ *      none
+ * Expects:
+ *      all arguments are not NULL. Throws CRE otherwise, or if malloc, a
+ *      read, or a write fails.
+ * Notes: 
+ *      A component that ended has its answer in its link; one that went
+ *      on shares the answer of the component it became, which the row
+ *      below has already worked out.
+ ************************/
+void settle_rows(FILE *spill, FILE *links, int height, Bit2_T line,
+                 uint64_t *words)
+{
+        assert(spill != NULL && links != NULL && line != NULL &&
+               words != NULL);
+
+        size_t room = (size_t) Bit2_width(line) / 2 + 1;
+        size_t row_bytes = Bit2_words_per_row(line) * sizeof(uint64_t);
+        RowComps comps = new_row_comps(room);
+        uint32_t *fate = malloc(room * sizeof(uint32_t));
+        unsigned char *below = malloc(room);
+        unsigned char *border = malloc(room);
+        assert(fate != NULL && below != NULL && border != NULL);
+
+        int seeked = fseeko(links, 0, SEEK_END);
+        assert(seeked == 0);
+        off_t end = ftello(links);
+
+        for (int row = height - 1; row >= 0; row--) {
+                int nruns = read_links(links, &end, &comps, fate);
+
+                for (int c = 0; c < comps.count; c++) {
+                        border[c] = fate[c] == CLOSED_BORDER ||
+                                    (fate[c] != CLOSED_INSIDE &&
+                                     below[fate[c]]);
+                }
+
+                seeked = fseeko(spill, (off_t) row * row_bytes, SEEK_SET);
+                assert(seeked == 0);
+                read_row(NULL, spill, line, words);
+
+                comps.runs.count = 0;
+                Bit2_map_runs(line, collect_run, &comps.runs);
+                assert(comps.runs.count == nruns);
 
-        if (col != Bit2_width(bit2) - 1) {
-                printf(" ");
-        } else if (col == Bit2_width(bit2) - 1 && 
-                row != Bit2_height(bit2) - 1) {
-                printf("\n");
+                for (int k = 0; k < nruns; k++) {
+                        Run *run = &comps.runs.items[k];
+
+                        if (border[comps.comp[k]]) {
+                                Bit2_fill_rect(line, run->start, 0,
+                                               run->end - run->start, 1, 0);
+                        }
+                }
+
+                seeked = fseeko(spill, (off_t) row * row_bytes, SEEK_SET);
+                assert(seeked == 0);
+                spill_row(spill, line, words);
+
+                unsigned char *swap = below;
+                below = border;
+                border = swap;
+        }
+
+        free_row_comps(&comps);
+        free(fate);
+        free(below);
+        free(border);
+}
+
+/******** write_rows ********
+ *
+ * Third streaming pass: print the whitened rows
+ *
+ * Parameters:
+ *      FILE *spill:    the rows, whitened by settle_rows
+ *      int height:     number of rows
+ *      Bit2_T line:    one-row bitmap to read each row into
+ *      uint64_t *words: room for one packed row
+ *      bool raw:       whether to print raw (P4) rows instead of plain
+ * Return: 
+ *      none
+ * Expects:
+ *      spill, line and words are not NULL. Throws CRE otherwise, or if the
+ *      spill file is short.
+ ************************/
+void write_rows(FILE *spill, int height, Bit2_T line, uint64_t *words,
+                bool raw)
+{
+        assert(spill != NULL && line != NULL && words != NULL);
+
+        int width = Bit2_width(line);
+
+        rewind(spill);
+        for (int row = 0; row < height; row++) {
+                read_row(NULL, spill, line, words);
+                if (raw) {
+                        Pbmwrite_raw_row(stdout, words, width);
+                } else {
+                        Pbmwrite_plain_row(stdout, words, width,
+                                           row == height - 1);
+                }
         }
-}
\ No newline at end of file
+}
+
+/******** write_links ********
+ *
+ * Append one row's links to the links file
+ *
+ * Parameters:
+ *      FILE *links:            the links file
+ *      RowComps *comps:        the row's runs and components
+ *      uint32_t *fate:         where each component went, from link_rows
+ * Return: 
+ *      none
+ * Expects:
+ *      all arguments are not NULL. Throws CRE otherwise, or if a write
+ *      fails.
+ * Notes: 
+ *      The component of each run, then the fate of each component, then
+ *      the two counts. Counts go last so read_links can walk the file
+ *      backwards.
+ ************************/
+void write_links(FILE *links, RowComps *comps, uint32_t *fate)
+{
+        assert(links != NULL && comps != NULL && fate != NULL);
+
+        size_t nruns = comps->runs.count;
+        size_t ncomps = comps->count;
+        uint32_t counts[2] = { nruns, ncomps };
+
+        size_t put = fwrite(comps->comp, sizeof(uint32_t), nruns, links);
+        put += fwrite(fate, sizeof(uint32_t), ncomps, links);
+        put += fwrite(counts, sizeof(uint32_t), 2, links);
+        assert(put == nruns + ncomps + 2);
+}
+
+/******** read_links ********
+ *
+ * Read the row's links that end at a given offset of the links file
+ *
+ * Parameters:
+ *      FILE *links:            the links file
+ *      off_t *end:             offset just past the row's links; moved back
+ *                              to where they start
+ *      RowComps *comps:        filled in with each run's component and the
+ *                              number of components
+ *      uint32_t *fate:         filled in with each component's fate
+ * Return: 
+ *      the number of runs in the row
+ * Expects:
+ *      all pointers are not NULL and the links were made by write_links.
+ *      Throws CRE otherwise, or if a read fails.
+ ************************/
+int read_links(FILE *links, off_t *end, RowComps *comps, uint32_t *fate)
+{
+        assert(links != NULL && end != NULL && comps != NULL &&
+               fate != NULL);
+
+        uint32_t counts[2];
+        int seeked = fseeko(links, *end - (off_t) sizeof(counts), SEEK_SET);
+        assert(seeked == 0);
+        size_t got = fread(counts, sizeof(uint32_t), 2, links);
+        assert(got == 2);
+
+        *end -= (off_t) ((counts[0] + counts[1] + 2) * sizeof(uint32_t));
+        seeked = fseeko(links, *end, SEEK_SET);
+        assert(seeked == 0);
+        got = fread(comps->comp, sizeof(uint32_t), counts[0], links);
+        got += fread(fate, sizeof(uint32_t), counts[1], links);
+        assert(got == counts[0] + counts[1]);
+
+        comps->count = counts[1];
+
+        return counts[0];
+}
+
+/******** new_row_comps ********
+ *
+ * Make an empty RowComps with room for a row's runs
+ *
+ * Parameters:
+ *      size_t room:    most runs a row can hold
+ * Return: 
+ *      the RowComps, with no runs and no components
+ * Expects:
+ *      Throws CRE if malloc fails
+ ************************/
+RowComps new_row_comps(size_t room)
+{
+        RowComps comps = { { malloc(room * sizeof(Run)), 0 },
+                           malloc(room * sizeof(uint32_t)), malloc(room), 0 };
+
+        assert(comps.runs.items != NULL && comps.comp != NULL &&
+               comps.border != NULL);
+
+        return comps;
+}
+
+/******** free_row_comps ********
+ *
+ * Free the arrays of a RowComps
+ *
+ * Parameters:
+ *      RowComps *comps:        the RowComps
+ * Return: 
+ *      none
+ * Expects:
+ *      comps is not NULL. Throws CRE otherwise.
+ ************************/
+void free_row_comps(RowComps *comps)
+{
+        assert(comps != NULL);
+
+        free(comps->runs.items);
+        free(comps->comp);
+        free(comps->border);
+}
+
+/******** read_row ********
+ *
+ * Read the next row of the image into a one-row bitmap
+ *
+ * Parameters:
+ *      Pnmrdr_T rdr:   reader to take pixels from, or NULL
+ *      FILE *spill:    spill file to take a packed row from, or NULL to
+ *                      use rdr
+ *      Bit2_T line:    one-row bitmap to fill
+ *      uint64_t *words: room for one packed row
+ * Return: 
+ *      none
+ * Expects:
+ *      line and words are not NULL, and rdr is not NULL when spill is NULL.
+ *      Throws CRE otherwise, or if the spill file is short.
+ * Notes: 
+ *      Pixels are packed a word at a time and stored with Bit2_put_row.
+ ************************/
+void read_row(Pnmrdr_T rdr, FILE *spill, Bit2_T line, uint64_t *words)
+{
+        assert(line != NULL && words != NULL && (spill != NULL || rdr != NULL));
+
+        int width = Bit2_width(line);
+        size_t n = Bit2_words_per_row(line);
+
+        if (spill != NULL) {
+                size_t got = fread(words, sizeof(uint64_t), n, spill);
+                assert(got == n);
+        } else {
+                for (int col = 0; col < width; col++) {
+                        if (col % 64 == 0) {
+                                words[col / 64] = 0;
+                        }
+                        words[col / 64] |= (uint64_t) (Pnmrdr_get(rdr) != 0)
+                                           << (col % 64);
+                }
+        }
+
+        Bit2_put_row(line, 0, words);
+}
+
+/******** spill_row ********
+ *
+ * Append a row to the spill file as packed words
+ *
+ * Parameters:
+ *      FILE *spill:    the spill file
+ *      Bit2_T line:    one-row bitmap holding the row
+ *      uint64_t *words: room for one packed row
+ * Return: 
+ *      none
+ * Expects:
+ *      all arguments are not NULL. Throws CRE otherwise, or if the write
+ *      fails.
+ ************************/
+void spill_row(FILE *spill, Bit2_T line, uint64_t *words)
+{
+        assert(spill != NULL && line != NULL && words != NULL);
+
+        size_t n = Bit2_words_per_row(line);
+
+        Bit2_get_row(line, 0, words);
+        size_t put = fwrite(words, sizeof(uint64_t), n, spill);
+        assert(put == n);
+}
+
+/******** collect_run ********
+ *
+ * Bit2_map_runs callback that appends each black run to a Runs
+ *
+ * Parameters:
+ *      int row:        unused
+ *      int start:      first column of the run
+ *      int length:     length of the run
+ *      int bit:        value of the run; white runs are skipped
+ *      Bit2_T line:    unused
+ *      void *runs:     the Runs to append to
+ * Return: 
+ *      none
+ * Expects:
+ *      runs is not NULL and has room. Throws CRE otherwise.
+ ************************/
+void collect_run(int row, int start, int length, int bit, Bit2_T line,
+                 void *runs)
+{
+        assert(runs != NULL);
+        (void) row;
+        (void) line;
+
+        if (bit == 0) {
+                return;
+        }
+
+        Runs *list = runs;
+        Run run = { start, start + length, 0 };
+
+        list->items[list->count++] = run;
+}
+
+/******** new_label ********
+ *
+ * Add a run to the union-find as a component of its own
+ *
+ * Parameters:
+ *      Labels *labels: the union-find
+ *      bool border:    whether the run touches the image border
+ * Return: 
+ *      the run's label
+ * Expects:
+ *      labels is not NULL. Throws CRE otherwise, if malloc fails, or if
+ *      there are more than UINT32_MAX runs.
+ * Notes: 
+ *      The arrays double when full.
+ ************************/
+uint32_t new_label(Labels *labels, bool border)
+{
+        assert(labels != NULL && labels->count < UINT32_MAX);
+
+        if (labels->count == labels->capacity) {
+                size_t capacity = labels->capacity == 0 ? WORKLIST_START :
+                                  labels->capacity * 2;
+
+                labels->parent = realloc(labels->parent,
+                                         capacity * sizeof(uint32_t));
+                labels->border = realloc(labels->border, capacity);
+                assert(labels->parent != NULL && labels->border != NULL);
+                labels->capacity = capacity;
+        }
+
+        uint32_t label = labels->count++;
+        labels->parent[label] = label;
+        labels->border[label] = border;
+
+        return label;
+}
+
+/******** find_label ********
+ *
+ * Find the root label of a run's component
+ *
+ * Parameters:
+ *      Labels *labels: the union-find
+ *      uint32_t label: the run's label
+ * Return: 
+ *      the component's root label
+ * Expects:
+ *      labels is not NULL and label was made by new_label
+ * Notes: 
+ *      Path halving: every other node on the way up is pointed at its
+ *      grandparent, so later finds are shorter.
+ ************************/
+uint32_t find_label(Labels *labels, uint32_t label)
+{
+        uint32_t *parent = labels->parent;
+
+        while (parent[label] != label) {
+                parent[label] = parent[parent[label]];
+                label = parent[label];
+        }
+
+        return label;
+}
+
+/******** join_labels ********
+ *
+ * Merge the components of two runs
+ *
+ * Parameters:
+ *      Labels *labels: the union-find
+ *      uint32_t a, b:  labels of the two runs
+ * Return: 
+ *      none
+ * Expects:
+ *      labels is not NULL and a and b were made by new_label
+ * Notes: 
+ *      The older root wins, and the merged component touches the border if
+ *      either part did.
+ ************************/
+void join_labels(Labels *labels, uint32_t a, uint32_t b)
+{
+        uint32_t root_a = find_label(labels, a);
+        uint32_t root_b = find_label(labels, b);
+
+        if (root_a == root_b) {
+                return;
+        }
+        if (root_b < root_a) {
+                uint32_t swap = root_a;
+                root_a = root_b;
+                root_b = swap;
+        }
+
+        labels->parent[root_b] = root_a;
+        labels->border[root_a] |= labels->border[root_b];
+}
+
+/******** pipeline_unblackedges ********
+ *
+ * Remove black edges with reading, cleaning and printing overlapped
+ *
+ * Parameters:
+ *      int argc:       argument count
+ *      char *argv[]:   argument array to access filename
+ *      bool raw:       whether to write a raw (P4) PBM instead of plain
+ * Return: 
+ *      none
+ * Expects:
+ *      argc is 1 or 2, and the input is a PBM. Throws CRE otherwise, or if
+ *      a thread cannot be started.
+ * Notes: 
+ *      Three stages, each on its own thread and each a batch of rows behind
+ *      the one before: read_stage parses rows into the bitmap, label_stage
+ *      (on this thread) labels their black runs and whitens each row once
+ *      its fate is settled, and write_stage prints the settled rows. The
+ *      total time tends toward that of the slowest stage.
+ ************************/
+void pipeline_unblackedges(int argc, char *argv[], bool raw)
+{
+        FILE *fp = openFile(argc, argv);
+        Pipeline pipeline;
+
+        pipeline.reader = Pbmread_new(fp);
+        pipeline.bit2 = Pbmread_bitmap(pipeline.reader);
+        pipeline.raw = raw;
+        pipeline.batch = PIPELINE_BATCH_PIXELS /
+                         (Bit2_width(pipeline.bit2) + 1) + 1;
+        init_progress(&pipeline.read);
+        init_progress(&pipeline.done);
+
+        /* Output Header to standard output */
+        printf("P%d\n%d %d\n", raw ? 4 : 1, Bit2_width(pipeline.bit2),
+               Bit2_height(pipeline.bit2));
+
+        pthread_t reader, writer;
+        int err = pthread_create(&reader, NULL, read_stage, &pipeline);
+        assert(err == 0);
+        err = pthread_create(&writer, NULL, write_stage, &pipeline);
+        assert(err == 0);
+
+        label_stage(&pipeline);
+
+        pthread_join(reader, NULL);
+        pthread_join(writer, NULL);
+
+        pthread_mutex_destroy(&pipeline.read.lock);
+        pthread_cond_destroy(&pipeline.read.moved);
+        pthread_mutex_destroy(&pipeline.done.lock);
+        pthread_cond_destroy(&pipeline.done.moved);
+        Pbmread_free(&pipeline.reader);
+        Bit2_free(&pipeline.bit2);
+        fclose(fp);
+}
+
+/******** read_stage ********
+ *
+ * First pipeline stage: parse the image into the bitmap, a batch of rows
+ * at a time
+ *
+ * Parameters:
+ *      void *pipeline: the shared Pipeline
+ * Return: 
+ *      NULL
+ * Expects:
+ *      pipeline is not NULL. Throws CRE otherwise, or if the input is not
+ *      a well-formed PBM.
+ ************************/
+void *read_stage(void *pipeline)
+{
+        assert(pipeline != NULL);
+
+        Pipeline *stages = pipeline;
+        int height = Bit2_height(stages->bit2);
+        int rows = 0;
+
+        while (rows < height) {
+                rows = Pbmread_more(stages->reader, stages->batch);
+                advance(&stages->read, rows);
+        }
+
+        return NULL;
+}
+
+/******** label_stage ********
+ *
+ * Second pipeline stage: label black runs as their rows arrive, and whiten
+ * each row once no run in it can still be joined to the border
+ *
+ * Parameters:
+ *      Pipeline *pipeline:     the shared pipeline
+ * Return: 
+ *      none
+ * Expects:
+ *      pipeline is not NULL. Throws CRE otherwise, or if malloc fails.
+ * Notes: 
+ *      Runs are joined to the runs they touch in the row above, as in
+ *      label_rows. After row r is labeled, a component with no run in row
+ *      r can never grow again, so whether it reaches the border is known.
+ *      The oldest unsettled row is settled, and whitened, once none of its
+ *      runs belongs to a component that is still open in row r; the last
+ *      row leaves nothing open. Settled rows' runs and labels are dropped
+ *      as they pile up, so memory follows the unsettled rows, not the
+ *      whole image.
+ ************************/
+void label_stage(Pipeline *pipeline)
+{
+        assert(pipeline != NULL);
+
+        Bit2_T bit2 = pipeline->bit2;
+        int height = Bit2_height(bit2);
+        Labels labels = { NULL, NULL, 0, 0 };
+        RunLog log = { NULL, 0, 0,
+                       malloc(((size_t) height + 1) * sizeof(size_t)) };
+        uint32_t *open = malloc(((size_t) Bit2_width(bit2) / 2 + 1) *
+                                sizeof(uint32_t));
+        assert(log.row_start != NULL && open != NULL);
+        int available = 0;
+        int settled = 0;
+        int handed_on = 0;
+
+        for (int row = 0; row < height; row++) {
+                if (row == available) {
+                        available = wait_past(&pipeline->read, row);
+                }
+                label_row(bit2, row, &labels, &log);
+
+                /* Roots of the components still open in this row */
+                size_t nopen = 0;
+                for (size_t k = log.row_start[row];
+                     row < height - 1 && k < log.row_start[row + 1]; k++) {
+                        open[nopen++] = find_label(&labels,
+                                                   log.items[k].label);
+                }
+                qsort(open, nopen, sizeof(uint32_t), compare_labels);
+
+                while (settled <= row &&
+                       row_closed(&labels, &log, settled, open, nopen)) {
+                        whiten_row(bit2, settled, &labels, &log);
+                        settled++;
+                }
+
+                if (settled - handed_on >= pipeline->batch ||
+                    settled == height) {
+                        advance(&pipeline->done, settled);
+                        handed_on = settled;
+                }
+
+                /* The next row is joined to this one, so keep it */
+                compact_log(&labels, &log, settled < row ? settled : row,
+                            row);
+        }
+
+        free(open);
+        free(log.items);
+        free(log.row_start);
+        free(labels.parent);
+        free(labels.border);
+}
+
+/******** write_stage ********
+ *
+ * Last pipeline stage: print rows as they are settled
+ *
+ * Parameters:
+ *      void *pipeline: the shared Pipeline
+ * Return: 
+ *      NULL
+ * Expects:
+ *      pipeline is not NULL. Throws CRE otherwise, if malloc fails, or if
+ *      a write fails.
+ * Notes: 
+ *      Prints in the same layout as the other engines
+ ************************/
+void *write_stage(void *pipeline)
+{
+        assert(pipeline != NULL);
+
+        Pipeline *stages = pipeline;
+        Bit2_T bit2 = stages->bit2;
+        int width = Bit2_width(bit2);
+        int height = Bit2_height(bit2);
+        uint64_t *words = malloc((Bit2_words_per_row(bit2) + 1) *
+                                 sizeof(uint64_t));
+        assert(words != NULL);
+        int written = 0;
+
+        while (written < height) {
+                int done = wait_past(&stages->done, written);
+
+                for (; written < done; written++) {
+                        Bit2_get_row(bit2, written, words);
+                        if (stages->raw) {
+                                Pbmwrite_raw_row(stdout, words, width);
+                        } else {
+                                Pbmwrite_plain_row(stdout, words, width,
+                                                   written == height - 1);
+                        }
+                }
+        }
+
+        free(words);
+
+        return NULL;
+}
+
+/******** label_row ********
+ *
+ * Label the black runs of one row and join them to the runs they touch in
+ * the row above
+ *
+ * Parameters:
+ *      Bit2_T bit2:    bitmap holding the row
+ *      int row:        the row, one past the last row labeled
+ *      Labels *labels: union-find to add the runs to
+ *      RunLog *log:    runs labeled so far, to append the row's runs to
+ * Return: 
+ *      none
+ * Expects:
+ *      all pointers are not NULL. Throws CRE otherwise, or if malloc fails.
+ * Notes: 
+ *      Run ends are found a word at a time with Bit2_next.
+ ************************/
+void label_row(Bit2_T bit2, int row, Labels *labels, RunLog *log)
+{
+        assert(bit2 != NULL && labels != NULL && log != NULL);
+
+        int width = Bit2_width(bit2);
+        int height = Bit2_height(bit2);
+        size_t above = row > 0 ? log->row_start[row - 1] : log->count;
+        size_t above_end = log->count;
+        int col = Bit2_next(bit2, 0, row, 1);
+
+        log->row_start[row] = log->count;
+
+        while (col < width) {
+                int end = Bit2_next(bit2, col, row, 0);
+                Run run = { col, end, new_label(labels, row == 0 ||
+                                                row == height - 1 ||
+                                                col == 0 || end == width) };
+
+                if (log->count == log->capacity) {
+                        log->capacity = log->capacity == 0 ? WORKLIST_START :
+                                        log->capacity * 2;
+                        log->items = realloc(log->items, log->capacity *
+                                                         sizeof(Run));
+                        assert(log->items != NULL);
+                }
+                log->items[log->count++] = run;
+
+                /* Runs above that end before this one never touch a later
+                 * one either */
+                while (above < above_end && log->items[above].end <= col) {
+                        above++;
+                }
+                for (size_t j = above; j < above_end &&
+                     log->items[j].start < end; j++) {
+                        join_labels(labels, log->items[j].label, run.label);
+                }
+
+                col = Bit2_next(bit2, end, row, 1);
+        }
+
+        log->row_start[row + 1] = log->count;
+}
+
+/******** compact_log ********
+ *
+ * Drop the runs of rows above a given row, and the labels that went with
+ * them, once they are at least half of what is kept
+ *
+ * Parameters:
+ *      Labels *labels: the union-find, one label per run in the log
+ *      RunLog *log:    runs labeled so far
+ *      int keep:       first row whose runs must be kept
+ *      int row:        last row labeled
+ * Return: 
+ *      none
+ * Expects:
+ *      labels and log are not NULL, and keep <= row. Throws CRE otherwise,
+ *      or if malloc fails.
+ * Notes: 
+ *      A run's label is its index in the log, so the kept runs are
+ *      relabeled from 0 in order. Each kept component becomes rooted at
+ *      its first kept run, which takes over the old root's border flag.
+ *      Waiting until the dropped runs outnumber the kept ones keeps the
+ *      copying to a constant amount per run.
+ ************************/
+void compact_log(Labels *labels, RunLog *log, int keep, int row)
+{
+        assert(labels != NULL && log != NULL && keep <= row);
+
+        size_t first = log->row_start[keep];
+        size_t live = log->count - first;
+
+        if (first == 0 || first < live) {
+                return;
+        }
+
+        uint32_t *parent = malloc((live + 1) * sizeof(uint32_t));
+        unsigned char *border = malloc(live + 1);
+        assert(parent != NULL && border != NULL);
+
+        /* Find every root before the old parents are reused as a map */
+        for (size_t j = 0; j < live; j++) {
+                parent[j] = find_label(labels, first + j);
+        }
+        for (size_t j = 0; j < live; j++) {
+                labels->parent[parent[j]] = UINT32_MAX;
+        }
+        for (size_t j = 0; j < live; j++) {
+                uint32_t root = parent[j];
+
+                border[j] = 0;
+                if (labels->parent[root] == UINT32_MAX) {
+                        labels->parent[root] = j;
+                        border[j] = labels->border[root];
+                }
+                parent[j] = labels->parent[root];
+        }
+
+        memcpy(labels->parent, parent, live * sizeof(uint32_t));
+        memcpy(labels->border, border, live);
+        labels->count = live;
+
+        memmove(log->items, log->items + first, live * sizeof(Run));
+        for (size_t j = 0; j < live; j++) {
+                log->items[j].label = j;
+        }
+        for (int r = keep; r <= row + 1; r++) {
+                log->row_start[r] -= first;
+        }
+        log->count = live;
+
+        free(parent);
+        free(border);
+}
+
+/******** row_closed ********
+ *
+ * Tell whether every run of a row belongs to a component that can no
+ * longer grow
+ *
+ * Parameters:
+ *      Labels *labels: the union-find
+ *      RunLog *log:    runs labeled so far
+ *      int row:        a labeled row
+ *      uint32_t *open: roots of the components still open, sorted
+ *      size_t nopen:   how many roots open holds
+ * Return: 
+ *      true if none of the row's runs has a root in open
+ * Expects:
+ *      labels and log are not NULL. Throws CRE otherwise.
+ ************************/
+bool row_closed(Labels *labels, RunLog *log, int row, uint32_t *open,
+                size_t nopen)
+{
+        assert(labels != NULL && log != NULL);
+
+        for (size_t k = log->row_start[row]; k < log->row_start[row + 1];
+             k++) {
+                uint32_t root = find_label(labels, log->items[k].label);
+
+                if (bsearch(&root, open, nopen, sizeof(uint32_t),
+                            compare_labels) != NULL) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+/******** whiten_row ********
+ *
+ * Whiten the runs of a settled row whose component reaches the border
+ *
+ * Parameters:
+ *      Bit2_T bit2:    bitmap holding the row
+ *      int row:        a settled row
+ *      Labels *labels: the union-find
+ *      RunLog *log:    runs labeled so far
+ * Return: 
+ *      none
+ * Expects:
+ *      all pointers are not NULL. Throws CRE otherwise.
+ ************************/
+void whiten_row(Bit2_T bit2, int row, Labels *labels, RunLog *log)
+{
+        assert(bit2 != NULL && labels != NULL && log != NULL);
+
+        for (size_t k = log->row_start[row]; k < log->row_start[row + 1];
+             k++) {
+                Run *run = &log->items[k];
+
+                if (labels->border[find_label(labels, run->label)]) {
+                        Bit2_fill_rect(bit2, run->start, row,
+                                       run->end - run->start, 1, 0);
+                }
+        }
+}
+
+/******** compare_labels ********
+ *
+ * Order two labels for qsort and bsearch
+ *
+ * Parameters:
+ *      const void *a:  pointer to a uint32_t label
+ *      const void *b:  pointer to another
+ * Return: 
+ *      negative, zero or positive as *a is below, equal to or above *b
+ * Expects:
+ *      a and b are not NULL
+ ************************/
+int compare_labels(const void *a, const void *b)
+{
+        uint32_t left = *(const uint32_t *) a;
+        uint32_t right = *(const uint32_t *) b;
+
+        return (left > right) - (left < right);
+}
+
+/******** init_progress ********
+ *
+ * Set up a stage's progress count at zero rows
+ *
+ * Parameters:
+ *      Progress *progress:     the count to set up
+ * Return: 
+ *      none
+ * Expects:
+ *      progress is not NULL. Throws CRE otherwise.
+ ************************/
+void init_progress(Progress *progress)
+{
+        assert(progress != NULL);
+
+        pthread_mutex_init(&progress->lock, NULL);
+        pthread_cond_init(&progress->moved, NULL);
+        progress->rows = 0;
+}
+
+/******** advance ********
+ *
+ * Hand rows on to the next stage
+ *
+ * Parameters:
+ *      Progress *progress:     the stage's count
+ *      int rows:               rows now finished, from the top
+ * Return: 
+ *      none
+ * Expects:
+ *      progress is not NULL. Throws CRE otherwise.
+ * Notes: 
+ *      The mutex also publishes the stage's writes to those rows.
+ ************************/
+void advance(Progress *progress, int rows)
+{
+        assert(progress != NULL);
+
+        pthread_mutex_lock(&progress->lock);
+        progress->rows = rows;
+        pthread_cond_broadcast(&progress->moved);
+        pthread_mutex_unlock(&progress->lock);
+}
+
+/******** wait_past ********
+ *
+ * Wait until a stage has finished more than a given number of rows
+ *
+ * Parameters:
+ *      Progress *progress:     the stage's count
+ *      int rows:               rows already handled by the caller
+ * Return: 
+ *      the stage's count, which is greater than rows
+ * Expects:
+ *      progress is not NULL, and the stage will get past rows. Throws CRE
+ *      if progress is NULL.
+ ************************/
+int wait_past(Progress *progress, int rows)
+{
+        assert(progress != NULL);
+
+        pthread_mutex_lock(&progress->lock);
+        while (progress->rows <= rows) {
+                pthread_cond_wait(&progress->moved, &progress->lock);
+        }
+        int count = progress->rows;
+        pthread_mutex_unlock(&progress->lock);
+
+        return count;
+}
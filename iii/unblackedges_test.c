@@ -0,0 +1,547 @@
+/*
+ *      unblackedges_test.c
+ *      Justin Paik (jpaik03), Alex Violet (aviole01)
+ *      September 25, 2025
+ *      iii
+ *
+ *      Regression test for ./unblackedges. Every engine (the default flood
+ *      fill, --propagate, --stream, --parallel, and --pipeline) is run on
+ *      each image named on the command line and read from stdin, writing
+ *      both plain (P1) and --raw (P4) output. Each output must match, byte
+ *      for byte, the expected image as Pbmwrite writes it. The expected
+ *      image is the reference solution where there is one, and otherwise a
+ *      pixel-by-pixel flood fill done here; random images, written as both
+ *      P1 and P4, cross-check the engines against that flood fill.
+ *
+ *      Usage: unblackedges_test
+ *      Run from the directory holding ./unblackedges and iii_testing.
+ *      Prints one line per failure and exits nonzero if there were any.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "bit2.h"
+#include "pbmread.h"
+#include "pbmwrite.h"
+#include "assert.h"
+
+/* Where the test images and their solutions live */
+#define EDGECASES "iii_testing/iii_image_edgecases/"
+#define SOLUTIONS "iii_testing/iii_image_solutions/"
+#define SUBMISSION "iii_testing/testingImageSubmission/"
+
+/* Random images tried, and the largest height one may have */
+#define IMAGES 24
+#define MAX_HEIGHT 30
+
+/* Room for one command line */
+#define COMMAND_BYTES 512
+
+/* Bytes read from a stream at a time */
+#define CHUNK_BYTES 65536
+
+/* An image to run, and its solution, or NULL to use the flood fill here */
+typedef struct fixture {
+        const char *image;
+        const char *solution;
+} Fixture;
+
+/* The bytes of one PBM */
+typedef struct bytes {
+        unsigned char *data;
+        size_t length;
+} Bytes;
+
+static const char *engines[] = {
+        "", "--propagate", "--stream", "--parallel", "--parallel=2",
+        "--pipeline"
+};
+
+int check_image(const char *path, Bit2_T expected);
+bool check_run(const char *command, Bytes expected);
+bool check_rejected(const char *path);
+Bytes run_command(const char *command, int *status);
+Bytes render(Bit2_T image, bool raw);
+Bytes read_all(FILE *fp);
+Bit2_T read_image(const char *path);
+Bit2_T unblack(Bit2_T image);
+Bit2_T make_image(int width, int height, int density, uint64_t *state);
+uint64_t next_random(uint64_t *state);
+
+/******** main ********
+ *
+ * Run every engine on the fixtures and on random images
+ *
+ * Parameters:
+ *      none
+ * Return:
+ *      0 if every output matched, EXIT_FAILURE otherwise
+ * Expects:
+ *      ./unblackedges has been built. Throws CRE if allocation fails or a
+ *      fixture cannot be read.
+ * Notes:
+ *      Selfie_sol.pbm is empty, so Selfie is checked against the flood
+ *      fill instead.
+ ************************/
+int main(void)
+{
+        static const Fixture fixtures[] = {
+                { EDGECASES "0by0.pbm", NULL },
+                { EDGECASES "comment.pbm", NULL },
+                { EDGECASES "simple.pbm", SOLUTIONS "simple_sol.pbm" },
+                { EDGECASES "all_black.pbm", SOLUTIONS "all_black_sol.pbm" },
+                { EDGECASES "all_white.pbm", SOLUTIONS "all_white_sol.pbm" },
+                { EDGECASES "black_chunks.pbm",
+                  SOLUTIONS "black_chunks_sol.pbm" },
+                { EDGECASES "diagonals.pbm", SOLUTIONS "diagonals_sol.pbm" },
+                { EDGECASES "spiral.pbm", SOLUTIONS "spiral_sol.pbm" },
+                { EDGECASES "Selfie.pbm", NULL },
+                { EDGECASES "notscaryatall.pbm", NULL },
+                { SUBMISSION "test1.pbm", SUBMISSION "answer1.pbm" },
+                { SUBMISSION "test2.pbm", SUBMISSION "answer2.pbm" },
+                { SUBMISSION "test3.pbm", SUBMISSION "answer3.pbm" }
+        };
+        static const int widths[] = { 1, 2, 63, 64, 65, 130 };
+        int nfixtures = sizeof(fixtures) / sizeof(fixtures[0]);
+        int nwidths = sizeof(widths) / sizeof(widths[0]);
+        uint64_t state = 0x9e3779b97f4a7c15u;
+        int failures = 0;
+
+        for (int i = 0; i < nfixtures; i++) {
+                Bit2_T expected;
+
+                if (fixtures[i].solution != NULL) {
+                        expected = read_image(fixtures[i].solution);
+                } else {
+                        Bit2_T image = read_image(fixtures[i].image);
+
+                        expected = unblack(image);
+                        Bit2_free(&image);
+                }
+                failures += check_image(fixtures[i].image, expected);
+                Bit2_free(&expected);
+        }
+
+        if (!check_rejected(EDGECASES "notapbm.txt")) {
+                failures++;
+        }
+
+        char path[] = "/tmp/unblackedges_testXXXXXX";
+        int fd = mkstemp(path);
+
+        assert(fd >= 0);
+        close(fd);
+
+        for (int i = 0; i < IMAGES; i++) {
+                int width = widths[i % nwidths];
+                int height = 1 + (int) (next_random(&state) % MAX_HEIGHT);
+                Bit2_T image = make_image(width, height, i % 3, &state);
+                Bit2_T expected = unblack(image);
+                FILE *fp = fopen(path, "wb");
+
+                assert(fp != NULL);
+                if (i % 2 == 0) {
+                        Pbmwrite_plain(fp, image);
+                } else {
+                        Pbmwrite_raw(fp, image);
+                }
+                fclose(fp);
+
+                failures += check_image(path, expected);
+                Bit2_free(&expected);
+                Bit2_free(&image);
+        }
+        remove(path);
+
+        printf("unblackedges_test: %d failure(s)\n", failures);
+
+        return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+/******** check_image ********
+ *
+ * Run every engine on one image and check each output
+ *
+ * Parameters:
+ *      const char *path:       the image to run on
+ *      Bit2_T expected:        what its black edges removed should look like
+ * Return:
+ *      the number of runs whose output was wrong
+ * Expects:
+ *      expected is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      Each engine reads the image once by name and once from stdin, and
+ *      writes it once as P1 and once as P4.
+ ************************/
+int check_image(const char *path, Bit2_T expected)
+{
+        Bytes plain = render(expected, false);
+        Bytes raw = render(expected, true);
+        int nengines = sizeof(engines) / sizeof(engines[0]);
+        int failures = 0;
+
+        for (int e = 0; e < nengines; e++) {
+                for (int form = 0; form < 4; form++) {
+                        char command[COMMAND_BYTES];
+                        bool is_raw = form % 2 == 1;
+
+                        snprintf(command, sizeof(command),
+                                 "./unblackedges %s %s %s %s", engines[e],
+                                 is_raw ? "--raw" : "",
+                                 form < 2 ? "" : "<", path);
+                        if (!check_run(command, is_raw ? raw : plain)) {
+                                printf("FAIL: %s\n", command);
+                                failures++;
+                        }
+                }
+        }
+
+        free(plain.data);
+        free(raw.data);
+
+        return failures;
+}
+
+/******** check_run ********
+ *
+ * Run one command and compare what it writes with the expected bytes
+ *
+ * Parameters:
+ *      const char *command:    the shell command to run
+ *      Bytes expected:         what it should write to stdout
+ * Return:
+ *      true if it exited with status 0 and wrote exactly the expected bytes
+ * Expects:
+ *      command is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+bool check_run(const char *command, Bytes expected)
+{
+        int status;
+        Bytes output = run_command(command, &status);
+        bool ok = status == 0 && output.length == expected.length &&
+                  memcmp(output.data, expected.data, expected.length) == 0;
+
+        free(output.data);
+
+        return ok;
+}
+
+/******** check_rejected ********
+ *
+ * Check that every engine refuses an input that is not a PBM
+ *
+ * Parameters:
+ *      const char *path:       the input to run on
+ * Return:
+ *      true if every engine exited with a nonzero status
+ * Expects:
+ *      path is not NULL. Throws CRE otherwise.
+ * Notes:
+ *      The engines' error messages are thrown away.
+ ************************/
+bool check_rejected(const char *path)
+{
+        int nengines = sizeof(engines) / sizeof(engines[0]);
+        bool ok = true;
+
+        for (int e = 0; e < nengines; e++) {
+                char command[COMMAND_BYTES];
+                int status;
+
+                snprintf(command, sizeof(command),
+                         "./unblackedges %s %s 2>/dev/null", engines[e], path);
+
+                Bytes output = run_command(command, &status);
+
+                free(output.data);
+                if (status == 0) {
+                        printf("FAIL: %s exited with status 0\n", command);
+                        ok = false;
+                }
+        }
+
+        return ok;
+}
+
+/******** run_command ********
+ *
+ * Run a shell command and collect its stdout
+ *
+ * Parameters:
+ *      const char *command:    the shell command to run
+ *      int *status:            set to its exit status, or -1 if it did not
+ *                              exit normally
+ * Return:
+ *      the bytes it wrote, which the caller frees
+ * Expects:
+ *      command and status are not NULL. Throws CRE otherwise, or if the
+ *      command cannot be started.
+ * Notes:
+ *      none
+ ************************/
+Bytes run_command(const char *command, int *status)
+{
+        assert(command != NULL && status != NULL);
+
+        FILE *pipe = popen(command, "r");
+
+        assert(pipe != NULL);
+
+        Bytes output = read_all(pipe);
+        int result = pclose(pipe);
+
+        *status = result != -1 && WIFEXITED(result) ? WEXITSTATUS(result) :
+                                                      -1;
+
+        return output;
+}
+
+/******** render ********
+ *
+ * Write an image the way ./unblackedges should
+ *
+ * Parameters:
+ *      Bit2_T image:   the image
+ *      bool raw:       write P4 instead of P1
+ * Return:
+ *      the bytes of the PBM, which the caller frees
+ * Expects:
+ *      image is not NULL. Throws CRE otherwise, or if the temporary file
+ *      cannot be made.
+ * Notes:
+ *      none
+ ************************/
+Bytes render(Bit2_T image, bool raw)
+{
+        FILE *fp = tmpfile();
+
+        assert(fp != NULL);
+        if (raw) {
+                Pbmwrite_raw(fp, image);
+        } else {
+                Pbmwrite_plain(fp, image);
+        }
+        rewind(fp);
+
+        Bytes bytes = read_all(fp);
+
+        fclose(fp);
+
+        return bytes;
+}
+
+/******** read_all ********
+ *
+ * Read a stream to its end
+ *
+ * Parameters:
+ *      FILE *fp:       the stream, left open
+ * Return:
+ *      every byte left in it, which the caller frees
+ * Expects:
+ *      fp is not NULL. Throws CRE otherwise, or if allocation fails.
+ * Notes:
+ *      data is never NULL, even when nothing was read.
+ ************************/
+Bytes read_all(FILE *fp)
+{
+        assert(fp != NULL);
+
+        size_t capacity = CHUNK_BYTES;
+        Bytes bytes = { malloc(capacity), 0 };
+
+        assert(bytes.data != NULL);
+        for (;;) {
+                if (bytes.length == capacity) {
+                        capacity *= 2;
+                        bytes.data = realloc(bytes.data, capacity);
+                        assert(bytes.data != NULL);
+                }
+
+                size_t got = fread(bytes.data + bytes.length, 1,
+                                   capacity - bytes.length, fp);
+
+                if (got == 0) {
+                        return bytes;
+                }
+                bytes.length += got;
+        }
+}
+
+/******** read_image ********
+ *
+ * Read a PBM from a file
+ *
+ * Parameters:
+ *      const char *path:       the file
+ * Return:
+ *      a new bitmap holding the image
+ * Expects:
+ *      path names a readable, well-formed PBM. Throws CRE otherwise.
+ * Notes:
+ *      none
+ ************************/
+Bit2_T read_image(const char *path)
+{
+        FILE *fp = fopen(path, "rb");
+
+        assert(fp != NULL);
+
+        Bit2_T image = Pbmread_read(fp);
+
+        fclose(fp);
+
+        return image;
+}
+
+/******** unblack ********
+ *
+ * Remove the black edges of an image one pixel at a time
+ *
+ * Parameters:
+ *      Bit2_T image:   the image, left alone
+ * Return:
+ *      a new bitmap: the image with every black pixel that is 4-connected
+ *      to a black border pixel made white
+ * Expects:
+ *      image is not NULL. Throws CRE otherwise, or if allocation fails.
+ * Notes:
+ *      Deliberately plain, sharing nothing with the engines: a stack of
+ *      pixels seeded from the border, with each pixel whitened as it is
+ *      pushed so none is pushed twice.
+ ************************/
+Bit2_T unblack(Bit2_T image)
+{
+        static const int steps[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 },
+                                         { 0, -1 } };
+        int width = Bit2_width(image);
+        int height = Bit2_height(image);
+        Bit2_T result = Bit2_new(width, height);
+        size_t capacity = 1024;
+        size_t count = 0;
+        int *stack = malloc(2 * capacity * sizeof(int));
+
+        assert(stack != NULL);
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(result, col, row, Bit2_get(image, col, row));
+                }
+        }
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        bool border = row == 0 || row == height - 1 ||
+                                      col == 0 || col == width - 1;
+
+                        if (!border || Bit2_get(result, col, row) == 0) {
+                                continue;
+                        }
+                        Bit2_put(result, col, row, 0);
+                        stack[2 * count] = col;
+                        stack[2 * count + 1] = row;
+                        count++;
+
+                        while (count > 0) {
+                                count--;
+
+                                int c = stack[2 * count];
+                                int r = stack[2 * count + 1];
+
+                                for (int s = 0; s < 4; s++) {
+                                        int nc = c + steps[s][0];
+                                        int nr = r + steps[s][1];
+
+                                        if (nc < 0 || nc >= width || nr < 0 ||
+                                            nr >= height ||
+                                            Bit2_get(result, nc, nr) == 0) {
+                                                continue;
+                                        }
+                                        if (count == capacity) {
+                                                capacity *= 2;
+                                                stack = realloc(stack,
+                                                        2 * capacity *
+                                                        sizeof(int));
+                                                assert(stack != NULL);
+                                        }
+                                        Bit2_put(result, nc, nr, 0);
+                                        stack[2 * count] = nc;
+                                        stack[2 * count + 1] = nr;
+                                        count++;
+                                }
+                        }
+                }
+        }
+
+        free(stack);
+
+        return result;
+}
+
+/******** make_image ********
+ *
+ * Build a random test image
+ *
+ * Parameters:
+ *      int width, height:      size of the image
+ *      int density:            0, 1 or 2 for a quarter, half or three
+ *                              quarters of the pixels black
+ *      uint64_t *state:        generator state, advanced
+ * Return:
+ *      a new bitmap of noise
+ * Expects:
+ *      Throws CRE if allocation fails
+ * Notes:
+ *      Noise is laid down a word at a time; Bit2_put_word keeps the row
+ *      padding zero.
+ ************************/
+Bit2_T make_image(int width, int height, int density, uint64_t *state)
+{
+        Bit2_T image = Bit2_new(width, height);
+        int words = Bit2_words_per_row(image);
+
+        for (int row = 0; row < height; row++) {
+                for (int word = 0; word < words; word++) {
+                        uint64_t bits = next_random(state);
+
+                        if (density == 0) {
+                                bits &= next_random(state);
+                        } else if (density == 2) {
+                                bits |= next_random(state);
+                        }
+                        Bit2_put_word(image, word, row, bits);
+                }
+        }
+
+        return image;
+}
+
+/******** next_random ********
+ *
+ * Step a xorshift64 generator
+ *
+ * Parameters:
+ *      uint64_t *state:        generator state, never 0
+ * Return:
+ *      the next 64 random bits
+ * Expects:
+ *      state is not NULL
+ * Notes:
+ *      none
+ ************************/
+uint64_t next_random(uint64_t *state)
+{
+        uint64_t x = *state;
+
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+
+        return x;
+}